@@ -7,6 +7,7 @@
 #include "cJSON.h"
 #include "crc.h"
 #include "flash_blob.h"
+#include "flash_package.h"
 #include "heap.h"
 #include "led.h"
 #include "stdio.h"
@@ -24,6 +25,9 @@ BurnerConfigInfo_t BurnerConfigInfo = {
     .ReadProtection = CONFIG_DEFAULT_READ_PROTECTION,
     .AutoRun        = CONFIG_DEFAULT_AUTO_RUN,
     .Verify         = CONFIG_DEFAULT_VERIFY,
+    .Incremental    = CONFIG_DEFAULT_INCREMENTAL,
+    .VoltageRange   = CONFIG_DEFAULT_VOLTAGE_RANGE,
+    .Parallelism    = CONFIG_DEFAULT_PARALLELISM,
 };
 
 /**
@@ -208,17 +212,18 @@ void BurnerConfig(void) {
         /* 判断是否为bin文件 */
         if ((memcmp(strrchr(BurnerConfigInfo.FilePath, '.'), ".bin", 4) == 0) ||
             (memcmp(strrchr(BurnerConfigInfo.FilePath, '.'), ".BIN", 4) == 0)) {
+            /* 按文件大小一次擦除, 由驱动选择最大的擦除粒度 */
+            LED_On(ERR);
+            W25QXX_EraseRange(SPI_FLASH_PROGRAM_ADDRESS,
+                              (f_size(file) < SPI_FLASH_PROGRAM_SIZE) ? f_size(file) : SPI_FLASH_PROGRAM_SIZE);
+            LED_Off(ERR);
             /* 开始复制文件 */
-            while ((f_read(file, str_buf, CONFIG_BUFFER_SIZE, &r_cnt) == FR_OK) &&
+            while ((prog_size < SPI_FLASH_PROGRAM_SIZE) &&
+                   (f_read(file, str_buf, CONFIG_BUFFER_SIZE, &r_cnt) == FR_OK) &&
                    (r_cnt != 0)) {
                 w_addr = SPI_FLASH_PROGRAM_ADDRESS + prog_size;   // 写入地址
-                if ((w_addr % W25QXX_BLOCK_SIZE) == 0) {
-                    /* 如果写入地址是块大小的整数倍，擦除块 */
-                    SPI_FLASH_Erase(w_addr);
-                    LED_OnOff(ERR);
-                }
-                SPI_FLASH_Write(str_buf, w_addr, r_cnt);   // 写入数据
-                prog_size += r_cnt;                        // 计数
+                SPI_FLASH_Write(str_buf, w_addr, r_cnt);          // 写入数据
+                prog_size += r_cnt;                               // 计数
                 LED_OnOff(RUN);
             }
         } /* 判断是否为hex文件 */
@@ -232,10 +237,10 @@ void BurnerConfig(void) {
             char*    end        = NULL;         // 结束符指针
             char*    poi        = NULL;         // 缓冲区处理指针
 
-            uint8_t* w_buf    = pvPortMalloc(W25QXX_BLOCK_SIZE);   // 写入缓冲区
-            uint32_t buf_addr = 0xFFFFFFFF;                        // 写入缓冲区地址
-            uint32_t w_flag[24];                                   // 写入标志 3M/4K/32bit
-            memset(w_flag, 0, sizeof(w_flag));                     // 初始化写入标志
+            uint8_t* w_buf    = pvPortMalloc(W25QXX_BLOCK_SIZE);                    // 写入缓冲区
+            uint32_t buf_addr = 0xFFFFFFFF;                                         // 写入缓冲区地址
+            uint32_t w_flag[SPI_FLASH_PROGRAM_SIZE_MAX / W25QXX_BLOCK_SIZE / 32];   // 写入标志 12M/4K/32bit
+            memset(w_flag, 0, sizeof(w_flag));                                      // 初始化写入标志
             prog_size = 0;
 
 #define FLASH_W_FLAG(addr) BIT_VAL(w_flag[((addr - SPI_FLASH_PROGRAM_ADDRESS) / W25QXX_BLOCK_SIZE) / 32], (addr - SPI_FLASH_PROGRAM_ADDRESS) / W25QXX_BLOCK_SIZE % 32)
@@ -314,6 +319,10 @@ void BurnerConfig(void) {
                             }
                             w_addr -= start_addr;                  // 减去起始地址
                             w_addr += SPI_FLASH_PROGRAM_ADDRESS;   // 烧录地址
+                            if (w_addr + *len > SPI_FLASH_PROGRAM_ADDRESS + SPI_FLASH_PROGRAM_SIZE) {
+                                end_flag = 1;   // 超出程序保存区
+                                break;
+                            }
                             if (prog_size < w_addr + *len) {
                                 prog_size = w_addr + *len;   // 更新烧录大小
                             }
@@ -466,6 +475,9 @@ void BurnerConfig(void) {
         CONFIG_OBJECT_INT(root, "readProtection", uint8_t, BurnerConfigInfo.ReadProtection, CONFIG_DEFAULT_READ_PROTECTION);
         CONFIG_OBJECT_INT(root, "autoRun", uint8_t, BurnerConfigInfo.AutoRun, CONFIG_DEFAULT_AUTO_RUN);
         CONFIG_OBJECT_INT(root, "verify", uint8_t, BurnerConfigInfo.Verify, CONFIG_DEFAULT_VERIFY);
+        CONFIG_OBJECT_INT(root, "incremental", uint8_t, BurnerConfigInfo.Incremental, CONFIG_DEFAULT_INCREMENTAL);
+        CONFIG_OBJECT_INT(root, "voltageRange", uint8_t, BurnerConfigInfo.VoltageRange, CONFIG_DEFAULT_VOLTAGE_RANGE);
+        CONFIG_OBJECT_INT(root, "programParallelism", uint8_t, BurnerConfigInfo.Parallelism, CONFIG_DEFAULT_PARALLELISM);
         /* 烧录地址 */
         if ((item = cJSON_GetObjectItem(root, "flashAddr")) != NULL) {
             if (cJSON_IsString(item)) {
@@ -532,6 +544,9 @@ void BurnerConfig(void) {
     }
     f_close(file);
 
+    /********************************* 导入算法包 *********************************/
+    FlashPackage_Load(Algo_Path, file, file_info, str_buf, CONFIG_BUFFER_SIZE);
+
     /********************************* 检查支持列表文件 *********************************/
     if (f_open(file, Supported_Path, FA_WRITE | FA_READ | FA_OPEN_ALWAYS) != FR_OK) {
         goto ex;
@@ -539,8 +554,8 @@ void BurnerConfig(void) {
     if (f_read(file, str_buf, CONFIG_BUFFER_SIZE, &r_cnt) != FR_OK) {
         goto ex;
     }
-    crc = CRC32_Update(0, str_buf, r_cnt);   // 计算CRC32校验码
-    FlashBlob_ListStr(str_buf);              // 获取支持列表字符串
+    crc = CRC32_Update(0, str_buf, r_cnt);            // 计算CRC32校验码
+    FlashBlob_ListStr(str_buf, CONFIG_BUFFER_SIZE);   // 获取支持列表字符串
     if (crc != CRC32_Update(0, (void*) str_buf, strlen(str_buf))) {
         f_res = f_lseek(file, 0);
         f_res = f_write(file, str_buf, strlen(str_buf), &r_cnt);
@@ -9,17 +9,25 @@
 #define Firmware_Path  "0:firmware"        // 固件文件路径
 #define Readme_Path    "0:readme.txt"      // 说明文件路径
 #define Supported_Path "0:supported.txt"   // 支持列表文件路径
+#define Algo_Path      "0:algo"            // 算法包目录路径
 
 #define CONFIG_BUFFER_SIZE 1024   // 配置缓冲区大小
 
 #define CONFIG_BUFFER1_SIZE (CONFIG_BUFFER_SIZE - CONFIG_BUFFER2_SIZE)   // 配置缓冲区1大小
 #define CONFIG_BUFFER2_SIZE (128)                                        // 配置缓冲区2大小
 
+#define CONFIG_CHIP_ERASE_OFF  0   // 按扇区擦除
+#define CONFIG_CHIP_ERASE_ON   1   // 擦除全片
+#define CONFIG_CHIP_ERASE_AUTO 2   // 按算法耗时参数自动选择
+
 #define CONFIG_DEFAULT_AUTO_BURNER     1              // 自动烧录标志
 #define CONFIG_DEFAULT_CHIP_ERASE      0              // 擦除全片
 #define CONFIG_DEFAULT_READ_PROTECTION 0              // 读保护
 #define CONFIG_DEFAULT_AUTO_RUN        1              // 自动运行
 #define CONFIG_DEFAULT_VERIFY          0              // 程序校验
+#define CONFIG_DEFAULT_INCREMENTAL     0              // 增量烧录
+#define CONFIG_DEFAULT_VOLTAGE_RANGE   3              // 目标电压范围
+#define CONFIG_DEFAULT_PARALLELISM     0              // 编程并行位数
 #define CONFIG_DEFAULT_FLASH_ADDRESS   "0x08000000"   // 烧录目标地址
 
 typedef struct {
@@ -29,10 +37,13 @@ typedef struct {
     uint32_t FlashAddress;         // 烧录起始地址
     char     FilePath[128];        // 文件路径
     uint32_t AutoBurner     : 1;   // 自动烧录标志
-    uint32_t ChipErase      : 1;   // 擦除全片
+    uint32_t ChipErase      : 2;   // 擦除全片
     uint32_t ReadProtection : 1;   // 锁定Flash
     uint32_t AutoRun        : 1;   // 自动运行
     uint32_t Verify         : 1;   // 程序校验
+    uint32_t Incremental    : 1;   // 增量烧录
+    uint32_t VoltageRange   : 3;   // 目标电压范围 1:1.8V~2.1V 2:2.1V~2.7V 3:2.7V~3.6V 4:2.7V~3.6V且有VPP
+    uint32_t Parallelism    : 7;   // 编程并行位数 8/16/32/64, 为0时按电压范围选择
     uint32_t CRC32;                // CRC32校验码
 } BurnerConfigInfo_t;
 
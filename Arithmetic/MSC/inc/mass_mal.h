@@ -54,6 +54,11 @@ uint16_t MAL_Init (uint8_t lun);
 uint16_t MAL_GetStatus (uint8_t lun);
 uint16_t MAL_Read(uint8_t lun, uint32_t Memory_Offset, uint32_t *Readbuff, uint16_t Transfer_Length);
 uint16_t MAL_Write(uint8_t lun, uint32_t Memory_Offset, uint32_t *Writebuff, uint16_t Transfer_Length);
+uint16_t MAL_ReadStart(uint8_t lun, uint32_t Memory_Offset, uint32_t *Readbuff, uint16_t Transfer_Length);
+void MAL_ReadWait(uint8_t lun);
+uint16_t MAL_Flush(uint8_t lun);
+void MAL_Release(uint8_t lun);
+void MAL_Idle(void);
 #endif /* __MASS_MAL_H */
 
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -65,6 +65,7 @@
 
 #define SCSI_REQUEST_SENSE                          0x03
 #define SCSI_START_STOP_UNIT                        0x1B
+#define SCSI_SYNCHRONIZE_CACHE10                    0x35
 #define SCSI_TEST_UNIT_READY                        0x00
 #define SCSI_WRITE6                                 0x0A
 #define SCSI_WRITE10                                0x2A
@@ -131,6 +132,7 @@ void SCSI_ModeSense10_Cmd (uint8_t lun);
 void SCSI_Write10_Cmd(uint8_t lun , uint32_t LBA , uint32_t BlockNbr);
 void SCSI_Read10_Cmd(uint8_t lun , uint32_t LBA , uint32_t BlockNbr);
 void SCSI_Verify10_Cmd(uint8_t lun);
+void SCSI_Synchronize_Cache_Cmd(uint8_t lun);
 
 void SCSI_Invalid_Cmd(uint8_t lun);
 void SCSI_Valid_Cmd(uint8_t lun);
@@ -198,6 +198,12 @@ void USB_Interrupts_Config(void)
   NVIC_InitStructure.NVIC_IRQChannel = USBWakeUp_IRQn;
   NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0;
   NVIC_Init(&NVIC_InitStructure);
+
+  /* Enable the SPI1 DMA receive interrupt, lower than USB: inside the USB
+     interrupt the transfer is finished by polling in SPI1_DmaWait */
+  NVIC_InitStructure.NVIC_IRQChannel = DMA1_Channel2_IRQn;
+  NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 3;
+  NVIC_Init(&NVIC_InitStructure);
  
 }
 
@@ -53,9 +53,23 @@
 #include "stdio.h"
 #include "FlashLayout.h"
 #include "led.h"
+#include "heap.h"
+#include "string.h"
 
 /* Private typedef -----------------------------------------------------------*/
+typedef struct {
+    uint32_t Address;   // 缓存的扇区地址, MAL_CACHE_NONE为空闲
+    uint32_t Tick;      // 最近访问时间, 用于LRU淘汰
+    uint8_t* Data;      // 扇区数据
+    uint8_t  Dirty;     // 数据未写入Flash
+} MAL_Cache_t;
+
 /* Private define ------------------------------------------------------------*/
+#define MAL_CACHE_COUNT 2            // 缓存扇区数
+#define MAL_CACHE_IDLE  200          // 主机停止写入多久后回写缓存(ms)
+#define MAL_CACHE_NONE  0xFFFFFFFF   // 空闲缓存地址
+#define MAL_PAGE_SIZE   256          // 比较和编程的页大小
+
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
 uint32_t Mass_Memory_Offset[2];
@@ -63,8 +77,123 @@ uint32_t Mass_Memory_Size[2];
 uint32_t Mass_Block_Size[2];
 uint32_t Mass_Block_Count[2];
 
+static MAL_Cache_t MAL_Cache[MAL_CACHE_COUNT] = {
+    {MAL_CACHE_NONE, 0, NULL, 0},
+    {MAL_CACHE_NONE, 0, NULL, 0},
+};
+
+extern uint32_t SysTick_Get(void);   // 获取系统滴答计数值
+
 /* Private function prototypes -----------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
+/*******************************************************************************
+* Function Name  : MAL_Program
+* Description    : 将一个扇区写入Flash, 先与Flash中的数据比较:
+*                  内容相同时跳过; 只需把1改为0时不擦除, 只编程变化的页;
+*                  否则擦除后只编程不是全0xFF的页
+* Input          : address: 扇区地址
+*                  data: 扇区数据
+* Output         : None
+* Return         : None
+*******************************************************************************/
+static void MAL_Program(uint32_t address, uint8_t* data)
+{
+    uint8_t  page[MAL_PAGE_SIZE];   // Flash中的页数据
+    uint32_t diff  = 0;             // 内容变化的页
+    uint8_t  erase = 0;             // 需要擦除
+    uint16_t i, j;
+
+    for (i = 0; i < W25QXX_BLOCK_SIZE / MAL_PAGE_SIZE; i++) {
+        W25QXX_Read(page, address + i * MAL_PAGE_SIZE, MAL_PAGE_SIZE);
+        for (j = 0; j < MAL_PAGE_SIZE; j++) {
+            if (page[j] != data[i * MAL_PAGE_SIZE + j]) {
+                diff |= 1UL << i;
+                /* 有位需要从0变为1 */
+                if ((page[j] & data[i * MAL_PAGE_SIZE + j]) != data[i * MAL_PAGE_SIZE + j]) {
+                    erase = 1;
+                }
+            }
+        }
+    }
+    if (diff == 0) {
+        return;
+    }
+    LED_On(ERR);
+    if (erase != 0) {
+        W25QXX_EraseSector(address);
+        /* 擦除后全0xFF的页无需编程 */
+        diff = 0;
+        for (i = 0; i < W25QXX_BLOCK_SIZE / MAL_PAGE_SIZE; i++) {
+            for (j = 0; j < MAL_PAGE_SIZE; j++) {
+                if (data[i * MAL_PAGE_SIZE + j] != 0xFF) {
+                    diff |= 1UL << i;
+                    break;
+                }
+            }
+        }
+    }
+    for (i = 0; i < W25QXX_BLOCK_SIZE / MAL_PAGE_SIZE; i++) {
+        if (diff & (1UL << i)) {
+            W25QXX_WritePage(&data[i * MAL_PAGE_SIZE], address + i * MAL_PAGE_SIZE, MAL_PAGE_SIZE);
+        }
+    }
+    LED_Off(ERR);
+}
+
+/*******************************************************************************
+* Function Name  : MAL_CacheFind
+* Description    : 查找缓存的扇区
+* Input          : address: 扇区地址
+* Output         : None
+* Return         : 缓存, 未缓存时返回NULL
+*******************************************************************************/
+static MAL_Cache_t* MAL_CacheFind(uint32_t address)
+{
+    for (uint8_t i = 0; i < MAL_CACHE_COUNT; i++) {
+        if (MAL_Cache[i].Address == address) {
+            return &MAL_Cache[i];
+        }
+    }
+    return NULL;
+}
+
+/*******************************************************************************
+* Function Name  : MAL_CacheAlloc
+* Description    : 分配一个缓存, 没有空闲缓存时淘汰最久未访问的扇区
+* Input          : flush: 0: 只淘汰已写入Flash的扇区, 1: 也可以回写并淘汰未写入的扇区
+* Output         : None
+* Return         : 缓存, 没有可淘汰的扇区或内存不足时返回NULL
+*******************************************************************************/
+static MAL_Cache_t* MAL_CacheAlloc(uint8_t flush)
+{
+    MAL_Cache_t* cache = NULL;
+
+    for (uint8_t i = 0; i < MAL_CACHE_COUNT; i++) {
+        if (MAL_Cache[i].Address == MAL_CACHE_NONE) {
+            cache = &MAL_Cache[i];
+            break;
+        }
+        if ((flush == 0) && (MAL_Cache[i].Dirty != 0)) {
+            continue;
+        }
+        if ((cache == NULL) || ((int32_t) (MAL_Cache[i].Tick - cache->Tick) < 0)) {
+            cache = &MAL_Cache[i];
+        }
+    }
+    if (cache == NULL) {
+        return NULL;
+    }
+    if (cache->Dirty != 0) {
+        MAL_Program(cache->Address, cache->Data);
+        cache->Dirty = 0;
+    }
+    cache->Address = MAL_CACHE_NONE;
+    if (cache->Data == NULL) {
+        cache->Data = pvPortMalloc(W25QXX_BLOCK_SIZE);
+    }
+    return (cache->Data != NULL) ? cache : NULL;
+}
+
 /*******************************************************************************
 * Function Name  : MAL_Init
 * Description    : Initializes the Media on the STM32
@@ -100,22 +229,30 @@ uint16_t MAL_Init(uint8_t lun)
 *******************************************************************************/
 uint16_t MAL_Write(uint8_t lun, uint32_t Memory_Offset, uint32_t *Writebuff, uint16_t Transfer_Length)
 {
-    uint16_t stat = MAL_FAIL;
+    uint16_t     stat = MAL_FAIL;
+    MAL_Cache_t* cache;
 
     switch (lun) {
         case 0: {
-            LED_On(ERR);
+            W25QXX_ReadWait();   // 等待预读结束
             Memory_Offset += Mass_Memory_Offset[0];
             while (Transfer_Length) {
-                W25QXX_EraseSector(Memory_Offset);
-                W25QXX_Write((uint8_t*) Writebuff,
-                             Memory_Offset,
-                             Mass_Block_Size[0]);
+                /* 写入回写缓存, 缓存内存不足时直接写入Flash */
+                if ((cache = MAL_CacheFind(Memory_Offset)) == NULL) {
+                    cache = MAL_CacheAlloc(1);
+                }
+                if (cache != NULL) {
+                    memcpy(cache->Data, Writebuff, Mass_Block_Size[0]);
+                    cache->Address = Memory_Offset;
+                    cache->Tick    = SysTick_Get();
+                    cache->Dirty   = 1;
+                } else {
+                    MAL_Program(Memory_Offset, (uint8_t*) Writebuff);
+                }
                 Memory_Offset += Mass_Block_Size[0];
                 Writebuff += Mass_Block_Size[0] / 4;
                 Transfer_Length -= Mass_Block_Size[0];
             }
-            LED_Off(ERR);
             stat = MAL_OK;
         } break;
     }
@@ -125,22 +262,41 @@ uint16_t MAL_Write(uint8_t lun, uint32_t Memory_Offset, uint32_t *Writebuff, uin
 
 /*******************************************************************************
 * Function Name  : MAL_Read
-* Description    : Read sectors
+* Description    : Read sectors, 未缓存的扇区读取后放入块缓存,
+*                  用于主机反复读取的FAT表和目录
 * Input          : None
 * * Output         : None
 * Return         : Buffer pointer
 *******************************************************************************/
 uint16_t MAL_Read(uint8_t lun, uint32_t Memory_Offset, uint32_t *Readbuff, uint16_t Transfer_Length)
 {
-    uint16_t stat = MAL_FAIL;
+    uint16_t     stat = MAL_FAIL;
+    MAL_Cache_t* cache;
 
     switch (lun) {
         case 0: {
             LED_On(ERR);
+            W25QXX_ReadWait();   // 等待预读结束
             Memory_Offset += Mass_Memory_Offset[0];
-            W25QXX_Read((uint8_t*) Readbuff,
-                        Memory_Offset,
-                        Transfer_Length);
+            while (Transfer_Length) {
+                /* 缓存中的扇区可能比Flash中的新 */
+                if ((cache = MAL_CacheFind(Memory_Offset)) != NULL) {
+                    memcpy(Readbuff, cache->Data, Mass_Block_Size[0]);
+                    cache->Tick = SysTick_Get();
+                } else {
+                    W25QXX_Read((uint8_t*) Readbuff,
+                                Memory_Offset,
+                                Mass_Block_Size[0]);
+                    if ((cache = MAL_CacheAlloc(0)) != NULL) {
+                        memcpy(cache->Data, Readbuff, Mass_Block_Size[0]);
+                        cache->Address = Memory_Offset;
+                        cache->Tick    = SysTick_Get();
+                    }
+                }
+                Memory_Offset += Mass_Block_Size[0];
+                Readbuff += Mass_Block_Size[0] / 4;
+                Transfer_Length -= Mass_Block_Size[0];
+            }
             LED_Off(ERR);
             stat = MAL_OK;
         } break;
@@ -148,6 +304,57 @@ uint16_t MAL_Read(uint8_t lun, uint32_t Memory_Offset, uint32_t *Readbuff, uint1
     return stat;
 }
 
+/*******************************************************************************
+* Function Name  : MAL_ReadStart
+* Description    : 启动后台读取, 读取范围不能跨越扇区;
+*                  扇区已缓存时直接复制, 否则由DMA读取, 须调用MAL_ReadWait等待结束
+* Input          : None
+* Output         : None
+* Return         : None
+*******************************************************************************/
+uint16_t MAL_ReadStart(uint8_t lun, uint32_t Memory_Offset, uint32_t *Readbuff, uint16_t Transfer_Length)
+{
+    uint16_t     stat = MAL_FAIL;
+    uint32_t     address;
+    MAL_Cache_t* cache;
+
+    switch (lun) {
+        case 0: {
+            W25QXX_ReadWait();   // 等待上次读取结束
+            Memory_Offset += Mass_Memory_Offset[0];
+            address = Memory_Offset - Memory_Offset % Mass_Block_Size[0];
+            if ((cache = MAL_CacheFind(address)) != NULL) {
+                memcpy(Readbuff, cache->Data + (Memory_Offset - address), Transfer_Length);
+                cache->Tick = SysTick_Get();
+            } else {
+                LED_On(ERR);
+                W25QXX_ReadStart((uint8_t*) Readbuff,
+                                 Memory_Offset,
+                                 Transfer_Length);
+            }
+            stat = MAL_OK;
+        } break;
+    }
+    return stat;
+}
+
+/*******************************************************************************
+* Function Name  : MAL_ReadWait
+* Description    : 等待后台读取结束
+* Input          : None
+* Output         : None
+* Return         : None
+*******************************************************************************/
+void MAL_ReadWait(uint8_t lun)
+{
+    switch (lun) {
+        case 0: {
+            W25QXX_ReadWait();
+            LED_Off(ERR);
+        } break;
+    }
+}
+
 /*******************************************************************************
 * Function Name  : MAL_GetStatus
 * Description    : Get status
@@ -167,5 +374,82 @@ uint16_t MAL_GetStatus (uint8_t lun)
     return stat;
 }
 
+/*******************************************************************************
+* Function Name  : MAL_Flush
+* Description    : 将缓存中未写入的扇区全部写入Flash, 写入后保留用于读取
+* Input          : lun: 逻辑单元号
+* Output         : None
+* Return         : None
+*******************************************************************************/
+uint16_t MAL_Flush(uint8_t lun)
+{
+    uint16_t stat = MAL_FAIL;
+
+    switch (lun) {
+        case 0: {
+            W25QXX_ReadWait();   // 等待预读结束
+            for (uint8_t i = 0; i < MAL_CACHE_COUNT; i++) {
+                if (MAL_Cache[i].Dirty != 0) {
+                    MAL_Program(MAL_Cache[i].Address, MAL_Cache[i].Data);
+                    MAL_Cache[i].Dirty = 0;
+                }
+            }
+            stat = MAL_OK;
+        } break;
+    }
+    return stat;
+}
+
+/*******************************************************************************
+* Function Name  : MAL_Release
+* Description    : 释放缓存占用的内存, 未写入Flash的扇区保留, 须先调用MAL_Flush
+* Input          : lun: 逻辑单元号
+* Output         : None
+* Return         : None
+*******************************************************************************/
+void MAL_Release(uint8_t lun)
+{
+    switch (lun) {
+        case 0: {
+            for (uint8_t i = 0; i < MAL_CACHE_COUNT; i++) {
+                if ((MAL_Cache[i].Dirty == 0) && (MAL_Cache[i].Data != NULL)) {
+                    vPortFree(MAL_Cache[i].Data);
+                    MAL_Cache[i].Data    = NULL;
+                    MAL_Cache[i].Address = MAL_CACHE_NONE;
+                }
+            }
+        } break;
+    }
+}
+
+/*******************************************************************************
+* Function Name  : MAL_Idle
+* Description    : 主机停止写入MAL_CACHE_IDLE后回写缓存, 在主循环中周期调用
+* Input          : None
+* Output         : None
+* Return         : None
+*******************************************************************************/
+void MAL_Idle(void)
+{
+    uint32_t tick  = SysTick_Get();
+    uint8_t  dirty = 0;   // 有未回写的扇区
+
+    for (uint8_t i = 0; i < MAL_CACHE_COUNT; i++) {
+        if (MAL_Cache[i].Dirty != 0) {
+            if (tick - MAL_Cache[i].Tick < MAL_CACHE_IDLE) {
+                return;
+            }
+            dirty = 1;
+        }
+    }
+    if (dirty == 0) {
+        return;
+    }
+    /* 回写期间屏蔽USB中断, 避免与中断中的读写冲突 */
+    NVIC_DisableIRQ(USB_LP_CAN1_RX0_IRQn);
+    MAL_Flush(0);
+    NVIC_EnableIRQ(USB_LP_CAN1_RX0_IRQn);
+}
+
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
 
@@ -61,6 +61,8 @@
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
+#define DATA_BUFFER_SIZE (BULK_MAX_PACKET_SIZE * 2 * 8 * sizeof(uint32_t)) /* 4096 bytes*/
+#define READ_AHEAD_SIZE  (DATA_BUFFER_SIZE / 2) /* 预读单位, Data_Buffer分为两半轮流发送和预读 */
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
 __IO uint32_t Block_Read_count = 0;
@@ -68,7 +70,7 @@ __IO uint32_t Block_offset;
 __IO uint32_t Counter = 0;
 uint32_t  Idx;
 // uint32_t Data_Buffer[BULK_MAX_PACKET_SIZE * 2 * 8]; /* 4096 bytes*/
-uint32_t *Data_Buffer = NULL; /* 4096 bytes*/
+uint32_t *Data_Buffer = NULL; /* DATA_BUFFER_SIZE bytes*/
 uint8_t TransferState = TXFR_IDLE;
 /* Extern variables ----------------------------------------------------------*/
 extern uint8_t Bulk_Data_Buff[BULK_MAX_PACKET_SIZE];  /* data buffer*/
@@ -93,40 +95,60 @@ extern uint32_t Mass_Block_Size[2];
 void Read_Memory(uint8_t lun, uint32_t Memory_Offset, uint32_t Transfer_Length)
 {
   static uint32_t Offset, Length;
-  
+  static uint32_t Ahead; /* 已读取或正在预读的结束位置 */
+
+  if (Data_Buffer == NULL) {
+    Data_Buffer = pvPortMalloc(DATA_BUFFER_SIZE);
+  }
+
   if (TransferState == TXFR_IDLE )
   {
     Offset = Memory_Offset * Mass_Block_Size[lun];
     Length = Transfer_Length * Mass_Block_Size[lun];
     TransferState = TXFR_ONGOING;
-  }
 
-  if (Data_Buffer == NULL) {
-    Data_Buffer = pvPortMalloc(BULK_MAX_PACKET_SIZE * 2 * 8 * sizeof(uint32_t));
-  }
-
-  if (TransferState == TXFR_ONGOING )
-  {
-    if (!Block_Read_count)
+    if (Transfer_Length == 1)
     {
+      /* 单块读取多为FAT表和目录, 经过块缓存读取 */
       MAL_Read(lun ,
                Offset ,
                Data_Buffer,
                Mass_Block_Size[lun]);
-
-      USB_SIL_Write(EP1_IN, (uint8_t *)Data_Buffer, BULK_MAX_PACKET_SIZE);
-
-      Block_Read_count = Mass_Block_Size[lun] - BULK_MAX_PACKET_SIZE;
-      Block_offset = BULK_MAX_PACKET_SIZE;
+      Ahead = Offset + Mass_Block_Size[lun];
     }
     else
     {
-      USB_SIL_Write(EP1_IN, (uint8_t *)Data_Buffer + Block_offset, BULK_MAX_PACKET_SIZE);
+      MAL_ReadStart(lun ,
+                    Offset ,
+                    Data_Buffer,
+                    READ_AHEAD_SIZE);
+      Ahead = Offset + READ_AHEAD_SIZE;
+    }
+  }
 
-      Block_Read_count -= BULK_MAX_PACKET_SIZE;
-      Block_offset += BULK_MAX_PACKET_SIZE;
+  if (TransferState == TXFR_ONGOING )
+  {
+    if (!Block_Read_count)
+    {
+      /* 当前一半读取完成后, 在发送期间预读下一半 */
+      MAL_ReadWait(lun);
+      if ((Ahead < Offset + Length) && (Ahead - Offset < DATA_BUFFER_SIZE))
+      {
+        MAL_ReadStart(lun ,
+                      Ahead ,
+                      (uint32_t *)((uint8_t *)Data_Buffer + Ahead % DATA_BUFFER_SIZE),
+                      READ_AHEAD_SIZE);
+        Ahead += READ_AHEAD_SIZE;
+      }
+      Block_Read_count = READ_AHEAD_SIZE;
+      Block_offset = Offset % DATA_BUFFER_SIZE;
     }
 
+    USB_SIL_Write(EP1_IN, (uint8_t *)Data_Buffer + Block_offset, BULK_MAX_PACKET_SIZE);
+
+    Block_Read_count -= BULK_MAX_PACKET_SIZE;
+    Block_offset += BULK_MAX_PACKET_SIZE;
+
     SetEPTxCount(ENDP1, BULK_MAX_PACKET_SIZE);
     SetEPTxStatus(ENDP1, EP_TX_VALID);  
     Offset += BULK_MAX_PACKET_SIZE;
@@ -166,7 +188,7 @@ void Write_Memory (uint8_t lun, uint32_t Memory_Offset, uint32_t Transfer_Length
   }
 
   if (Data_Buffer == NULL) {
-    Data_Buffer = pvPortMalloc(BULK_MAX_PACKET_SIZE * 2 * 8 * sizeof(uint32_t));
+    Data_Buffer = pvPortMalloc(DATA_BUFFER_SIZE);
   }
 
   if (TransferState == TXFR_ONGOING )
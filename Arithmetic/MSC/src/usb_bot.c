@@ -232,6 +232,9 @@ void CBW_Decode(void)
         case SCSI_VERIFY10:
           SCSI_Verify10_Cmd(CBW.bLUN);
           break;
+        case SCSI_SYNCHRONIZE_CACHE10:
+          SCSI_Synchronize_Cache_Cmd(CBW.bLUN);
+          break;
         case SCSI_FORMAT_UNIT:
           SCSI_Format_Cmd(CBW.bLUN);
           break;
@@ -235,6 +235,21 @@ void Set_Scsi_Sense_Data(uint8_t lun, uint8_t Sens_Key, uint8_t Asc)
 *******************************************************************************/
 void SCSI_Start_Stop_Unit_Cmd(uint8_t lun)
 {
+  /* 弹出前回写缓存 */
+  MAL_Flush(lun);
+  Set_CSW (CSW_CMD_PASSED, SEND_CSW_ENABLE);
+}
+
+/*******************************************************************************
+* Function Name  : SCSI_Synchronize_Cache_Cmd
+* Description    : SCSI Synchronize_Cache Command routine.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void SCSI_Synchronize_Cache_Cmd(uint8_t lun)
+{
+  MAL_Flush(lun);
   Set_CSW (CSW_CMD_PASSED, SEND_CSW_ENABLE);
 }
 
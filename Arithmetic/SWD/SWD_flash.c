@@ -3,20 +3,386 @@
  * @brief   通过SWD协议对MCU的FLASH编程
  */
 #include "SWD_flash.h"
+#include "crc.h"
 #include "stdlib.h"
 #include "swd_host.h"
 
-static program_target_t* FlashBlob = NULL;
+#define FLASH_BUFFER_MAX (0x8000)       // 运行时编程缓冲区大小上限
+#define FLASH_ALGO_SLOT  (0x1000)       // 每个算法槽的大小(算法代码、静态数据、栈和自带缓冲区)
+#define FLASH_ALGO_TAG   (0x4F474C41)   // 驻留标记 'ALGO'
+#define FLASH_ALGO_CHUNK (128)          // 从SPI Flash分块读取算法代码的大小
+
+typedef struct {
+    uint32_t addr;    // 第一个扇区地址
+    uint32_t size;    // 扇区大小
+    uint32_t count;   // 扇区数
+} erase_run_t;        // 擦除段, 与辅助算法EraseRange的参数表格式一致
+
+static program_target_t* FlashBlob      = NULL;
+static error_t           FlashPending   = ERROR_SUCCESS;   // 后台执行的操作失败时的错误码, 空闲为ERROR_SUCCESS
+static uint8_t           FlashIndex     = 0;               // 下一次使用的编程缓冲区
+static uint32_t          FlashBuffer[2] = {0};             // 编程缓冲区地址, [1]为0时单缓冲
+static uint32_t          FlashBufSize   = 0;               // 编程缓冲区大小
+static uint32_t          FlashFillAddr  = 0;               // 当前缓冲区数据对应的Flash地址
+static uint32_t          FlashFillSize  = 0;               // 当前缓冲区已写入的数据大小
+static uint8_t           FlashSlot      = 0;               // 当前算法所在的算法槽
+static uint32_t          FlashOffset    = 0;               // 算法重定位偏移
+static program_syscall_t FlashSysCall;                     // 重定位后的系统调用参数
+static uint8_t           FlashCommon    = 0;               // 通用辅助算法已随编程算法下载
+
+/**
+ * @brief  获取地址所在的扇区信息
+ * @note   地址超出扇区表时返回最后一组扇区信息
+ * @param  addr: 目标Flash地址
+ * @retval 扇区信息指针
+ */
+static const sector_info_t* flash_sector_info(uint32_t addr) {
+    uint8_t index = 0;
+
+    addr &= 0x07FFFFFF;
+    while (index < FlashBlob->sector_info_count - 1) {
+        if (addr >= FlashBlob->sector_info[index].AddrSector &&
+            addr < FlashBlob->sector_info[index + 1].AddrSector) {
+            break;
+        }
+        index++;
+    }
+
+    return &FlashBlob->sector_info[index];
+}
+
+/**
+ * @brief  获取一组扇区中需要擦除的部分
+ * @note   需要擦除的是起始地址位于[addr, addr+size)内的扇区, 由扇区表直接算出, 不逐块查找
+ * @param  index: 扇区表序号
+ * @param  addr: 起始地址
+ * @param  size: 字节数
+ * @param  run: 返回擦除段
+ * @retval 1: 有需要擦除的扇区, 0: 没有
+ */
+static uint8_t flash_erase_run(uint32_t index, uint32_t addr, uint32_t size, erase_run_t* run) {
+    const sector_info_t* info  = &FlashBlob->sector_info[index];
+    uint32_t             start = addr & 0x07FFFFFF;
+    uint32_t             end   = start + size;
+    uint32_t             first = info->AddrSector;
+
+    // 最后一组扇区延续到范围结束
+    if ((index + 1 < FlashBlob->sector_info_count) && (end > info[1].AddrSector)) {
+        end = info[1].AddrSector;
+    }
+    if (start > first) {
+        first += (start - first + info->szSector - 1) / info->szSector * info->szSector;
+    }
+    if (first >= end) {
+        return 0;
+    }
+
+    run->addr  = (addr & 0xF8000000) + first;
+    run->size  = info->szSector;
+    run->count = (end - first + info->szSector - 1) / info->szSector;
+
+    return 1;
+}
+
+/**
+ * @brief  获取算法在SRAM中占用的大小
+ * @note   包括算法代码、静态数据、栈和算法自带的编程缓冲区
+ * @param  None
+ * @retval 占用大小(字节)
+ */
+static uint32_t flash_algo_footprint(void) {
+    uint32_t end = FlashBlob->sys_call_s.stack_pointer;
+
+    if (end < FlashBlob->program_buffer + FlashBlob->program_buffer_size) {
+        end = FlashBlob->program_buffer + FlashBlob->program_buffer_size;
+    }
+    if (end < FlashBlob->program_buffer2 + FlashBlob->program_buffer_size) {
+        end = FlashBlob->program_buffer2 + FlashBlob->program_buffer_size;
+    }
+
+    return end - FlashBlob->algo_start;
+}
+
+/**
+ * @brief  获取可用的算法槽数量
+ * @note   SRAM足够时在首尾各放置一个算法槽
+ * @param  ram_size: 目标SRAM大小(字节)
+ * @retval 算法槽数量
+ */
+static uint8_t flash_algo_slots(uint32_t ram_size) {
+    if ((flash_algo_footprint() <= FLASH_ALGO_SLOT) && (ram_size >= FLASH_ALGO_SLOT * 2)) {
+        return 2;
+    }
+    return 1;
+}
+
+/**
+ * @brief  放置编程缓冲区
+ * @note   空闲SRAM平分为两个编程缓冲区, 不足以放下比算法自带缓冲区更大的缓冲区时
+ *         使用算法自带的缓冲区. 缓冲区大小取2的幂, 使每次编程不会跨越缓冲区大小对齐的地址边界
+ * @param  start: 空闲SRAM起始地址
+ * @param  free: 空闲SRAM大小(字节)
+ * @retval None
+ */
+static void flash_buffer_layout(uint32_t start, uint32_t free) {
+    uint32_t size  = FLASH_BUFFER_MAX;
+    uint8_t  count = (FlashBlob->program_buffer2 != 0) ? 2 : 1;
+
+    FlashBuffer[0] = FlashBlob->program_buffer + FlashOffset;
+    FlashBuffer[1] = (count == 2) ? (FlashBlob->program_buffer2 + FlashOffset) : 0;
+    FlashBufSize   = FlashBlob->program_buffer_size;
+
+    while ((size > FlashBufSize) && (size * count > free)) {
+        size >>= 1;
+    }
+    if (size <= FlashBufSize) {
+        return;
+    }
+
+    FlashBuffer[0] = start;
+    FlashBuffer[1] = (count == 2) ? (start + size) : 0;
+    FlashBufSize   = size;
+}
+
+/**
+ * @brief  计算编程算法代码的CRC
+ * @note   导入的算法包代码位于SPI Flash, 分块读取计算
+ * @param  crc: CRC初值
+ * @retval CRC32
+ */
+static uint32_t flash_algo_crc(uint32_t crc) {
+    uint8_t  buf[FLASH_ALGO_CHUNK];
+    uint32_t size;
+
+    if (FlashBlob->algo_blob != NULL) {
+        return CRC32_Update(crc, (void*) FlashBlob->algo_blob, FlashBlob->algo_size);
+    }
+    for (uint32_t offset = 0; offset < FlashBlob->algo_size; offset += size) {
+        size = FlashBlob->algo_size - offset;
+        size = (size > sizeof(buf)) ? sizeof(buf) : size;
+        FlashBlob_Read(FlashBlob, offset, buf, size);
+        crc = CRC32_Update(crc, buf, size);
+    }
+    return crc;
+}
+
+/**
+ * @brief  写入编程算法代码到目标SRAM
+ * @note   导入的算法包代码从SPI Flash分块读取后直接写入, 不在本机缓存整个算法
+ * @param  addr: 目标地址
+ * @retval 0: 成功, -1: 失败
+ */
+static int8_t flash_algo_write(uint32_t addr) {
+    uint8_t  buf[FLASH_ALGO_CHUNK];
+    uint32_t size;
+
+    if (FlashBlob->algo_blob != NULL) {
+        return swd_write_memory(addr, (uint8_t*) FlashBlob->algo_blob, FlashBlob->algo_size);
+    }
+    for (uint32_t offset = 0; offset < FlashBlob->algo_size; offset += size) {
+        size = FlashBlob->algo_size - offset;
+        size = (size > sizeof(buf)) ? sizeof(buf) : size;
+        FlashBlob_Read(FlashBlob, offset, buf, size);
+        if (swd_write_memory(addr + offset, buf, size) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief  抽查目标SRAM中的代码字
+ * @note   逐个比较各入口点所在的字和代码末字, 入口点去掉Thumb位后按字对齐, 不在代码范围内时跳过
+ * @param  prog: 编程算法, 为NULL时检查通用辅助算法
+ * @param  start: 代码起始地址(重定位前)
+ * @param  size: 代码大小
+ * @param  entry: 入口点地址表
+ * @param  count: 入口点数量
+ * @retval 1: 一致, 0: 不一致或读取失败
+ */
+static uint8_t flash_algo_sample(const program_target_t* prog, uint32_t start, uint32_t size, const uint32_t* entry, uint8_t count) {
+    uint32_t offset;
+    uint32_t expect;
+    uint32_t actual;
+
+    for (uint8_t i = 0; i <= count; i++) {
+        offset = (i < count) ? ((entry[i] & ~3UL) - start) : ((size & ~3UL) - 4);
+        if ((size < 4) || (offset > size - 4)) {
+            continue;
+        }
+        if (prog != NULL) {
+            FlashBlob_Read(prog, offset, &expect, sizeof(expect));
+        } else {
+            expect = flash_common.algo_blob[offset / 4];
+        }
+        if ((swd_read_memory(start + FlashOffset + offset, (uint8_t*) &actual, sizeof(actual)) != 0) ||
+            (actual != expect)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief  检查算法槽中的算法是否完好
+ * @note   驻留标记一致后再抽查编程算法和通用辅助算法的入口点和末字,
+ *         目标程序改写过算法区时重新下载. 只读回少量字, 不读回整个算法
+ * @retval 1: 完好, 0: 需要重新下载
+ */
+static uint8_t flash_algo_resident(void) {
+    const uint32_t entry[] = {
+        FlashBlob->init,
+        FlashBlob->uninit,
+        FlashBlob->erase_chip,
+        FlashBlob->erase_sector,
+        FlashBlob->program_page,
+        FlashBlob->set_rdp,
+        FlashBlob->verify,
+    };
+    const uint32_t common[] = {
+        flash_common.crc_check,
+        flash_common.blank_check,
+        flash_common.erase_range,
+    };
+
+    if (flash_algo_sample(FlashBlob, FlashBlob->algo_start, FlashBlob->algo_size, entry, sizeof(entry) / sizeof(entry[0])) == 0) {
+        return 0;
+    }
+    if ((FlashCommon != 0) &&
+        (flash_algo_sample(NULL, flash_common.algo_start, flash_common.algo_size, common, sizeof(common) / sizeof(common[0])) == 0)) {
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief  下载编程算法
+ * @note   SRAM足够时分为首尾两个算法槽, 选项字算法和Flash算法可同时驻留.
+ *         通用辅助算法随编程算法一起下载. 编程缓冲区之前保存驻留标记{'ALGO', 代码CRC}, 标记与本算法一致
+ *         且抽查的代码字也一致时认为算法仍然驻留(复位不会清除SRAM), 不再重新下载
+ * @param  ram_size: 目标SRAM大小(字节)
+ * @retval ERROR_SUCCESS: 成功, 其他: 失败错误码
+ */
+static error_t flash_algo_load(uint32_t ram_size) {
+    uint32_t tag_addr = FlashBlob->program_buffer - sizeof(uint32_t) * 2;
+    uint32_t base[2]  = {FlashBlob->algo_start, FlashBlob->algo_start + ram_size - FLASH_ALGO_SLOT};
+    uint8_t  count    = flash_algo_slots(ram_size);
+    uint32_t tag[2]   = {FLASH_ALGO_TAG, flash_algo_crc(0)};
+    uint32_t check[2];
+    uint8_t  slot;
+
+    // 通用辅助算法放在编程算法之后, 放不下时不使用
+    FlashCommon = ((FlashBlob->algo_start + FlashBlob->algo_size <= flash_common.algo_start) &&
+                   (flash_common.algo_start + flash_common.algo_size <= tag_addr));
+    if (FlashCommon != 0) {
+        tag[1] = CRC32_Update(tag[1], (void*) flash_common.algo_blob, flash_common.algo_size);
+    }
+
+    // 代码与缓冲区之间放不下标记时每次都下载
+    if (FlashBlob->algo_start + FlashBlob->algo_size > tag_addr) {
+        count = 0;
+    }
+
+    // 查找驻留的算法
+    for (slot = 0; slot < count; slot++) {
+        FlashOffset = base[slot] - FlashBlob->algo_start;
+        if ((swd_read_memory(tag_addr + FlashOffset, (uint8_t*) check, sizeof(check)) == 0) &&
+            (check[0] == tag[0]) &&
+            (check[1] == tag[1]) &&
+            (flash_algo_resident() != 0)) {
+            FlashSlot = slot;
+            return ERROR_SUCCESS;
+        }
+    }
+
+    // 放入另一个算法槽, 保留上一次使用的算法
+    FlashSlot   = (count == 2) ? (FlashSlot ^ 1) : 0;
+    FlashOffset = base[FlashSlot] - FlashBlob->algo_start;
+    if (count != 0) {
+        // 先清除旧标记, 下载中断时不会误判为驻留
+        check[0] = 0;
+        check[1] = 0;
+        if (swd_write_memory(tag_addr + FlashOffset, (uint8_t*) check, sizeof(check)) != 0) {
+            return ERROR_ALGO_DL;
+        }
+    }
+    if (flash_algo_write(base[FlashSlot]) != 0) {
+        return ERROR_ALGO_DL;
+    }
+    if ((FlashCommon != 0) &&
+        (swd_write_memory(flash_common.algo_start + FlashOffset,
+                          (uint8_t*) flash_common.algo_blob,
+                          flash_common.algo_size) != 0)) {
+        return ERROR_ALGO_DL;
+    }
+    if ((count != 0) &&
+        (swd_write_memory(tag_addr + FlashOffset, (uint8_t*) tag, sizeof(tag)) != 0)) {
+        return ERROR_ALGO_DL;
+    }
+
+    return ERROR_SUCCESS;
+}
+
+/**
+ * @brief  启动Flash算法函数
+ * @note   按操作的耗时参数设置等待内核停止的查询计划
+ * @param  entry: 入口点地址(重定位前)
+ * @param  arg1: 参数1
+ * @param  arg2: 参数2
+ * @param  arg3: 参数3
+ * @param  arg4: 参数4
+ * @param  time: 操作耗时参数, 为NULL时不限时
+ * @param  scale: 耗时倍数 (按KB计时的操作为数据量KB数)
+ * @retval 0: 成功, -1: 失败
+ */
+static int8_t flash_syscall_start(uint32_t entry, uint32_t arg1, uint32_t arg2, uint32_t arg3, uint32_t arg4, const program_time_t* time, uint32_t scale) {
+    if (swd_flash_syscall_start(&FlashSysCall,
+                                entry + FlashOffset,
+                                arg1,
+                                arg2,
+                                arg3,
+                                arg4) != 0) {
+        return -1;
+    }
+    if (time != NULL) {
+        swd_set_halt_timing(time->typ * scale, time->max * scale);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief  等待Flash算法函数结束
+ * @param  result: 函数返回值
+ * @param  error: 失败时返回的错误码
+ * @retval ERROR_SUCCESS: 成功, ERROR_TIMEOUT: 超时, 其他: 失败错误码
+ */
+static error_t flash_syscall_wait(uint32_t* result, error_t error) {
+    switch (swd_flash_syscall_wait(result)) {
+        case 0:
+            return ERROR_SUCCESS;
+        case -2:
+            return ERROR_TIMEOUT;
+        default:
+            return error;
+    }
+}
 
 /**
  * @brief  初始化目标Flash
  * @note   设置Flash编程算法并进行初始化
  * @param  prog: Flash编程目标结构体指针
  * @param  flash_start: Flash起始地址
+ * @param  ram_size: 目标SRAM大小(字节), 为0时使用算法自身的缓冲区布局
  * @retval ERROR_SUCCESS: 成功, 其他: 失败错误码
  */
-error_t target_flash_init(const program_target_t* prog, uint32_t flash_start) {
-    FlashBlob = (program_target_t*) prog;
+error_t target_flash_init(const program_target_t* prog, uint32_t flash_start, uint32_t ram_size) {
+    FlashBlob     = (program_target_t*) prog;
+    FlashPending  = ERROR_SUCCESS;
+    FlashIndex    = 0;
+    FlashFillSize = 0;
+    uint32_t result;
+    error_t  status;
     if (FlashBlob->init == NULL) {
         return ERROR_FAILURE;
     }
@@ -24,25 +390,144 @@ error_t target_flash_init(const program_target_t* prog, uint32_t flash_start) {
         return ERROR_RESET;
     }
 
-    // 下载编程算法到目标MCU的SRAM，并初始化
-    if (swd_write_memory(FlashBlob->algo_start,
-                         (uint8_t*) FlashBlob->algo_blob,
-                         FlashBlob->algo_size) != 0) {
-        return ERROR_ALGO_DL;
+    // 下载编程算法到目标MCU的SRAM(已驻留时跳过)，并初始化
+    if ((status = flash_algo_load(ram_size)) != ERROR_SUCCESS) {
+        return status;
+    }
+    FlashSysCall.breakpoint    = FlashBlob->sys_call_s.breakpoint + FlashOffset;
+    FlashSysCall.static_base   = FlashBlob->sys_call_s.static_base + FlashOffset;
+    FlashSysCall.stack_pointer = FlashBlob->sys_call_s.stack_pointer + FlashOffset;
+    if (flash_algo_slots(ram_size) == 2) {
+        // 编程缓冲区位于首尾两个算法槽之间
+        flash_buffer_layout(FlashBlob->algo_start + FLASH_ALGO_SLOT, ram_size - FLASH_ALGO_SLOT * 2);
+    } else if (ram_size > flash_algo_footprint()) {
+        flash_buffer_layout(FlashBlob->algo_start + flash_algo_footprint(), ram_size - flash_algo_footprint());
+    } else {
+        flash_buffer_layout(0, 0);
     }
 
-    if (swd_flash_syscall_exec(&FlashBlob->sys_call_s,
-                               FlashBlob->init,
-                               flash_start,
-                               0,
-                               0,
-                               0) != 0) {
+    if (flash_syscall_start(FlashBlob->init, flash_start, 0, 0, 0, NULL, 0) != 0) {
         return ERROR_INIT;
     }
+    if ((flash_syscall_wait(&result, ERROR_INIT) != ERROR_SUCCESS) || (result != 0)) {
+        return ERROR_INIT;
+    }
+
+    return ERROR_SUCCESS;
+}
+
+/**
+ * @brief  查询目标Flash操作状态
+ * @note   不阻塞，用于在目标执行擦除或编程期间处理其他工作
+ * @param  None
+ * @retval ERROR_BUSY: 正在执行, ERROR_SUCCESS: 成功或空闲, 其他: 失败错误码
+ */
+error_t target_flash_poll(void) {
+    error_t  status = FlashPending;
+    uint32_t result;
+
+    if (status == ERROR_SUCCESS) {
+        return ERROR_SUCCESS;
+    }
+
+    switch (swd_flash_syscall_poll(&result)) {
+        case 1:
+            return ERROR_BUSY;
+        case 0:
+            if (result == 0) {
+                status = ERROR_SUCCESS;
+            }
+            break;
+        case -2:
+            status = ERROR_TIMEOUT;
+            break;
+        default:
+            break;
+    }
+    FlashPending = ERROR_SUCCESS;
+
+    return status;
+}
+
+/**
+ * @brief  等待后台执行的Flash操作结束
+ * @param  None
+ * @retval ERROR_SUCCESS: 成功或空闲, 其他: 失败错误码
+ */
+static error_t flash_wait(void) {
+    error_t  pending = FlashPending;
+    error_t  status;
+    uint32_t result;
+
+    if (pending == ERROR_SUCCESS) {
+        return ERROR_SUCCESS;
+    }
+    FlashPending = ERROR_SUCCESS;
+
+    if ((status = flash_syscall_wait(&result, pending)) != ERROR_SUCCESS) {
+        return status;
+    }
+    if (result != 0) {
+        return pending;
+    }
 
     return ERROR_SUCCESS;
 }
 
+/**
+ * @brief  编程当前缓冲区中的数据
+ * @note   等待上一次编程结束后启动本缓冲区的编程, 不等待其完成
+ * @param  None
+ * @retval ERROR_SUCCESS: 成功, 其他: 失败错误码
+ */
+static error_t flash_program_flush(void) {
+    error_t  status;
+    uint32_t size = FlashFillSize;
+
+    if (size == 0) {
+        return ERROR_SUCCESS;
+    }
+    FlashFillSize = 0;
+
+    // Wait for the previous buffer
+    if ((status = flash_wait()) != ERROR_SUCCESS) {
+        return status;
+    }
+
+    // Start flash programming, the result is collected by the next sync
+    if (flash_syscall_start(FlashBlob->program_page,
+                            FlashFillAddr,
+                            size,
+                            FlashBuffer[FlashIndex],
+                            0,
+                            &FlashBlob->timing.program_page,
+                            (size + 1023) / 1024) != 0) {
+        return ERROR_WRITE;
+    }
+    FlashPending = ERROR_WRITE;
+    if (FlashBuffer[1] != 0) {
+        FlashIndex ^= 1;
+    }
+
+    return ERROR_SUCCESS;
+}
+
+/**
+ * @brief  等待目标Flash操作完成
+ * @note   先编程缓冲区中剩余的数据, 再等待后台执行的擦除或编程结束，并返回其结果
+ * @param  None
+ * @retval ERROR_SUCCESS: 成功, 其他: 失败错误码
+ */
+error_t target_flash_sync(void) {
+    error_t status;
+
+    if ((status = flash_program_flush()) != ERROR_SUCCESS) {
+        return status;
+    }
+
+    return flash_wait();
+}
+
 /**
  * @brief  反初始化目标Flash
  * @note   执行Flash编程完成后的清理工作
@@ -50,17 +535,21 @@ error_t target_flash_init(const program_target_t* prog, uint32_t flash_start) {
  * @retval ERROR_SUCCESS: 成功, 其他: 失败错误码
  */
 error_t target_flash_uninit(void) {
+    error_t  status;
+    uint32_t result;
+
     if (FlashBlob == NULL ||
         FlashBlob->uninit == NULL) {
         return ERROR_FAILURE;
     }
+    if ((status = target_flash_sync()) != ERROR_SUCCESS) {
+        return status;
+    }
 
-    if (swd_flash_syscall_exec(&FlashBlob->sys_call_s,
-                               FlashBlob->uninit,
-                               0,
-                               0,
-                               0,
-                               0) != 0) {
+    if (flash_syscall_start(FlashBlob->uninit, 0, 0, 0, 0, NULL, 0) != 0) {
+        return ERROR_UINIT;
+    }
+    if ((flash_syscall_wait(&result, ERROR_UINIT) != ERROR_SUCCESS) || (result != 0)) {
         return ERROR_UINIT;
     }
 
@@ -69,41 +558,63 @@ error_t target_flash_uninit(void) {
 
 /**
  * @brief  编程Flash页面
- * @note   将数据写入到指定Flash地址
+ * @note   数据先写入目标SRAM的编程缓冲区, 缓冲区写满或地址不连续时才启动编程.
+ *         目标编程一个缓冲区时，后续数据下载到另一个空闲缓冲区，
+ *         返回时可能仍有数据未编程完成，需调用target_flash_sync等待结果
  * @param  addr: 目标Flash地址
  * @param  buf: 数据缓冲区指针
  * @param  size: 数据大小（字节）
  * @retval ERROR_SUCCESS: 成功, 其他: 失败错误码
  */
 error_t target_flash_program_page(uint32_t addr, const uint8_t* buf, uint32_t size) {
+    error_t status;
+
     if (FlashBlob == NULL ||
         FlashBlob->program_page == NULL) {
         return ERROR_FAILURE;
     }
 
     while (size > 0) {
-        uint32_t write_size = size > FlashBlob->program_buffer_size ? FlashBlob->program_buffer_size : size;
+        // 地址不连续时先编程已缓存的数据
+        if ((FlashFillSize != 0) && (addr != FlashFillAddr + FlashFillSize)) {
+            if ((status = flash_program_flush()) != ERROR_SUCCESS) {
+                return status;
+            }
+        }
+        if (FlashFillSize == 0) {
+            if (FlashBuffer[1] == 0) {
+                // 单缓冲: 等待上一次编程结束后才能改写缓冲区
+                if ((status = flash_wait()) != ERROR_SUCCESS) {
+                    return status;
+                }
+            }
+            FlashFillAddr = addr;
+        }
+
+        // 本次写入不超过缓冲区大小对齐的边界
+        uint32_t write_size = FlashBufSize - (addr & (FlashBufSize - 1));
+        if (write_size > size) {
+            write_size = size;
+        }
 
-        // Write page to buffer
-        if (swd_write_memory(FlashBlob->program_buffer,
+        // Write page to the idle buffer
+        if (swd_write_memory(FlashBuffer[FlashIndex] + FlashFillSize,
                              (uint8_t*) buf,
                              write_size) != 0) {
             return ERROR_ALGO_DATA_SEQ;
         }
-
-        // Run flash programming
-        if (swd_flash_syscall_exec(&FlashBlob->sys_call_s,
-                                   FlashBlob->program_page,
-                                   addr,
-                                   write_size,
-                                   FlashBlob->program_buffer,
-                                   0) != 0) {
-            return ERROR_WRITE;
-        }
+        FlashFillSize += write_size;
 
         addr += write_size;
         buf += write_size;
         size -= write_size;
+
+        // 缓冲区已满
+        if ((addr & (FlashBufSize - 1)) == 0) {
+            if ((status = flash_program_flush()) != ERROR_SUCCESS) {
+                return status;
+            }
+        }
     }
 
     return ERROR_SUCCESS;
@@ -116,23 +627,154 @@ error_t target_flash_program_page(uint32_t addr, const uint8_t* buf, uint32_t si
  * @retval ERROR_SUCCESS: 成功, 其他: 失败错误码
  */
 error_t target_flash_erase_sector(uint32_t addr) {
+    error_t status;
+
+    if ((status = target_flash_erase_sector_start(addr)) != ERROR_SUCCESS) {
+        return status;
+    }
+
+    return target_flash_sync();
+}
+
+/**
+ * @brief  启动Flash扇区擦除
+ * @note   擦除在目标上后台执行，通过target_flash_poll或target_flash_sync获取结果；
+ *         辅助算法可用时按单个扇区的范围擦除, 由EraseRange在同一次系统调用中跳过空白扇区
+ * @param  addr: 目标Flash地址
+ * @retval ERROR_SUCCESS: 成功, 其他: 失败错误码
+ */
+error_t target_flash_erase_sector_start(uint32_t addr) {
+    const sector_info_t* info;
+    uint32_t             size;
+    error_t              status;
+
+    if (FlashBlob == NULL ||
+        FlashBlob->erase_sector == NULL) {
+        return ERROR_FAILURE;
+    }
+
+    info = flash_sector_info(addr);
+    size = info->szSector;
+    if (FlashCommon != 0) {
+        // 对齐到扇区起始地址
+        addr -= ((addr & 0x07FFFFFF) - info->AddrSector) % size;
+        return target_flash_erase_range_start(addr, size);
+    }
+
+    if ((status = target_flash_sync()) != ERROR_SUCCESS) {
+        return status;
+    }
+    if (flash_syscall_start(FlashBlob->erase_sector,
+                            addr,
+                            0,
+                            0,
+                            0,
+                            &FlashBlob->timing.erase_sector,
+                            size / 1024) != 0) {
+        return ERROR_ERASE_SECTOR;
+    }
+    FlashPending = ERROR_ERASE_SECTOR;
+
+    return ERROR_SUCCESS;
+}
+
+/**
+ * @brief  启动范围擦除
+ * @note   擦除起始地址位于[addr, addr+size)内的扇区. 按扇区表生成擦除段表写入空闲的编程缓冲区,
+ *         由辅助算法EraseRange一次系统调用擦除全部扇区(跳过空白扇区), 在目标上后台执行;
+ *         辅助算法不可用时逐个扇区擦除, 最后一个扇区在后台执行
+ * @param  addr: 起始地址
+ * @param  size: 字节数
+ * @retval ERROR_SUCCESS: 成功, 其他: 失败错误码
+ */
+error_t target_flash_erase_range_start(uint32_t addr, uint32_t size) {
+    uint32_t    runs = 0;   // 擦除段数
+    uint32_t    typ  = 0;   // 单个扇区的典型耗时
+    uint32_t    max  = 0;   // 全部扇区的最大耗时
+    uint32_t    list;       // 擦除段表地址
+    uint32_t    index;
+    erase_run_t run;
+    error_t     status;
+
     if (FlashBlob == NULL ||
         FlashBlob->erase_sector == NULL) {
         return ERROR_FAILURE;
     }
+    if ((status = target_flash_sync()) != ERROR_SUCCESS) {
+        return status;
+    }
 
-    if (swd_flash_syscall_exec(&FlashBlob->sys_call_s,
-                               FlashBlob->erase_sector,
-                               addr,
-                               0,
-                               0,
-                               0) != 0) {
+    // 段表放在下一次编程不使用的缓冲区
+    list = FlashBuffer[(FlashBuffer[1] != 0) ? (FlashIndex ^ 1) : 0];
+    for (index = 0; index < FlashBlob->sector_info_count; index++) {
+        if (flash_erase_run(index, addr, size, &run) == 0) {
+            continue;
+        }
+        if (FlashCommon == 0) {
+            for (; run.count > 0; run.count--, run.addr += run.size) {
+                if ((status = target_flash_erase_sector_start(run.addr)) != ERROR_SUCCESS) {
+                    return status;
+                }
+            }
+            continue;
+        }
+        if ((runs + 1) * sizeof(run) > FlashBufSize) {
+            return ERROR_ERASE_SECTOR;
+        }
+        if (swd_write_memory(list + runs * sizeof(run), (uint8_t*) &run, sizeof(run)) != 0) {
+            return ERROR_ERASE_SECTOR;
+        }
+        if (runs++ == 0) {
+            typ = FlashBlob->timing.erase_sector.typ * (run.size / 1024);
+        }
+        max += FlashBlob->timing.erase_sector.max * (run.size / 1024) * run.count;
+    }
+    if (runs == 0) {
+        return ERROR_SUCCESS;
+    }
+
+    if (flash_syscall_start(flash_common.erase_range,
+                            list,
+                            runs,
+                            FlashBlob->erase_sector + FlashOffset,
+                            0,
+                            NULL,
+                            0) != 0) {
         return ERROR_ERASE_SECTOR;
     }
+    // 空白扇区被跳过, 实际耗时不确定, 按单个扇区的耗时开始查询
+    swd_set_halt_timing(typ, max);
+    FlashPending = ERROR_ERASE_SECTOR;
 
     return ERROR_SUCCESS;
 }
 
+/**
+ * @brief  判断整片擦除是否比按扇区擦除更快
+ * @note   按算法的耗时参数估算: 擦除[addr, addr+size)内扇区的典型耗时之和与整片擦除的典型耗时比较
+ * @param  addr: 起始地址
+ * @param  size: 字节数
+ * @retval 1: 整片擦除更快, 0: 按扇区擦除更快或不支持整片擦除
+ */
+uint8_t target_flash_erase_chip_faster(uint32_t addr, uint32_t size) {
+    uint32_t    cost = 0;
+    uint32_t    index;
+    erase_run_t run;
+
+    if (FlashBlob == NULL ||
+        FlashBlob->erase_chip == NULL) {
+        return 0;
+    }
+
+    for (index = 0; index < FlashBlob->sector_info_count; index++) {
+        if (flash_erase_run(index, addr, size, &run) != 0) {
+            cost += FlashBlob->timing.erase_sector.typ * (run.size / 1024) * run.count;
+        }
+    }
+
+    return (FlashBlob->timing.erase_chip.typ < cost);
+}
+
 /**
  * @brief  擦除整个Flash芯片
  * @note   擦除目标Flash的所有内容
@@ -144,18 +786,29 @@ error_t target_flash_erase_chip(void) {
         FlashBlob->erase_chip == NULL) {
         return ERROR_FAILURE;
     }
-    error_t status = ERROR_SUCCESS;
+    error_t status = target_flash_sync();
+    if (status != ERROR_SUCCESS) {
+        return status;
+    }
 
-    if (swd_flash_syscall_exec(&FlashBlob->sys_call_s,
-                               FlashBlob->erase_chip,
-                               0,
-                               0,
-                               0,
-                               0) != 0) {
+    uint32_t result;
+    if (flash_syscall_start(FlashBlob->erase_chip,
+                            0,
+                            0,
+                            0,
+                            0,
+                            &FlashBlob->timing.erase_chip,
+                            1) != 0) {
+        return ERROR_ERASE_ALL;
+    }
+    if ((status = flash_syscall_wait(&result, ERROR_ERASE_ALL)) != ERROR_SUCCESS) {
+        return status;
+    }
+    if (result != 0) {
         return ERROR_ERASE_ALL;
     }
 
-    return status;
+    return ERROR_SUCCESS;
 }
 
 /**
@@ -165,17 +818,21 @@ error_t target_flash_erase_chip(void) {
  * @retval ERROR_SUCCESS: 成功, 其他: 失败错误码
  */
 error_t target_flash_set_rdp(void) {
+    error_t  status;
+    uint32_t result;
+
     if (FlashBlob == NULL ||
         FlashBlob->set_rdp == NULL) {
         return ERROR_FAILURE;
     }
+    if ((status = target_flash_sync()) != ERROR_SUCCESS) {
+        return status;
+    }
 
-    if (swd_flash_syscall_exec(&FlashBlob->sys_call_s,
-                               FlashBlob->set_rdp,
-                               0,
-                               0,
-                               0,
-                               0) != 0) {
+    if (flash_syscall_start(FlashBlob->set_rdp, 0, 0, 0, 0, NULL, 0) != 0) {
+        return ERROR_SET_RDP;
+    }
+    if ((flash_syscall_wait(&result, ERROR_SET_RDP) != ERROR_SUCCESS) || (result != 0)) {
         return ERROR_SET_RDP;
     }
 
@@ -191,29 +848,121 @@ error_t target_flash_set_rdp(void) {
  * @retval ERROR_SUCCESS: 成功, 其他: 失败错误码
  */
 error_t target_flash_verify(uint32_t addr, uint32_t size, uint32_t crc) {
+    error_t status;
+
     if (FlashBlob == NULL ||
         FlashBlob->verify == NULL) {
         return ERROR_FAILURE;
     }
+    if ((status = target_flash_sync()) != ERROR_SUCCESS) {
+        return status;
+    }
 
     // Write page to buffer
-    if (swd_write_memory(FlashBlob->program_buffer,
+    if (swd_write_memory(FlashBuffer[0],
                          (uint8_t*) &crc,
                          4) != 0) {
         return ERROR_VERIFY;
     }
-    uint32_t res = swd_flash_syscall_exec(&FlashBlob->sys_call_s,
-                                          FlashBlob->verify,
-                                          addr,
-                                          size,
-                                          FlashBlob->program_buffer,
-                                          0);
+    uint32_t res;
+    if (flash_syscall_start(FlashBlob->verify,
+                            addr,
+                            size,
+                            FlashBuffer[0],
+                            0,
+                            &FlashBlob->timing.verify,
+                            (size + 1023) / 1024) != 0) {
+        return ERROR_VERIFY;
+    }
+    if ((status = flash_syscall_wait(&res, ERROR_VERIFY)) != ERROR_SUCCESS) {
+        return status;
+    }
     if (res != (addr + size)) {
         return ERROR_VERIFY;
     }
     return ERROR_SUCCESS;
 }
 
+/**
+ * @brief  获取分块CRC校验表的容量
+ * @note   校验表存放在编程缓冲区中, 通用辅助算法不可用时返回0
+ * @param  None
+ * @retval 校验表最大字节数
+ */
+uint32_t target_flash_crc_capacity(void) {
+    if ((FlashBlob == NULL) || (FlashCommon == 0)) {
+        return 0;
+    }
+    return FlashBufSize;
+}
+
+/**
+ * @brief  写入分块CRC校验表
+ * @note   等待后台操作完成后写入编程缓冲区
+ * @param  offset: 校验表内偏移(字节)
+ * @param  buf: 校验表数据
+ * @param  size: 数据大小(字节)
+ * @retval ERROR_SUCCESS: 成功, 其他: 失败错误码
+ */
+error_t target_flash_crc_table(uint32_t offset, const uint8_t* buf, uint32_t size) {
+    error_t status;
+
+    if ((offset + size) > target_flash_crc_capacity()) {
+        return ERROR_FAILURE;
+    }
+    if ((status = target_flash_sync()) != ERROR_SUCCESS) {
+        return status;
+    }
+
+    if (swd_write_memory(FlashBuffer[0] + offset,
+                         (uint8_t*) buf,
+                         size) != 0) {
+        return ERROR_VERIFY;
+    }
+
+    return ERROR_SUCCESS;
+}
+
+/**
+ * @brief  分块CRC校验Flash内容
+ * @note   一次系统调用校验整个范围, 每块的CRC32与已写入的校验表比较
+ * @param  addr: 目标Flash地址
+ * @param  size: 数据大小（字节）
+ * @param  chunk: 分块大小（字节）
+ * @param  offset: 第一块在校验表内的偏移(字节)
+ * @param  count: 返回校验一致的块数
+ * @retval ERROR_SUCCESS: 全部一致, ERROR_VERIFY: 存在不一致的块, 其他: 失败错误码
+ */
+error_t target_flash_crc_check(uint32_t addr, uint32_t size, uint32_t chunk, uint32_t offset, uint32_t* count) {
+    error_t status;
+
+    *count = 0;
+    if ((offset + (size + chunk - 1) / chunk * 4) > target_flash_crc_capacity()) {
+        return ERROR_FAILURE;
+    }
+    if ((status = target_flash_sync()) != ERROR_SUCCESS) {
+        return status;
+    }
+
+    if (flash_syscall_start(flash_common.crc_check,
+                            addr,
+                            size,
+                            FlashBuffer[0] + offset,
+                            chunk,
+                            &flash_common.timing.crc_check,
+                            (size + 1023) / 1024) != 0) {
+        return ERROR_VERIFY;
+    }
+    if ((status = flash_syscall_wait(count, ERROR_VERIFY)) != ERROR_SUCCESS) {
+        return status;
+    }
+    if (*count != (size + chunk - 1) / chunk) {
+        return ERROR_VERIFY;
+    }
+
+    return ERROR_SUCCESS;
+}
+
 /**
  * @brief  检查地址是否为扇区整数倍
  * @note   检查给定地址是否对齐到扇区边界
@@ -224,17 +973,9 @@ uint8_t target_flash_sector_integer(uint32_t addr) {
     if (FlashBlob == NULL || FlashBlob->sector_info_count == 0) {
         return 0;
     }
-    addr &= 0x07FFFFFF;
-    uint8_t index = 0;
-    while (index < FlashBlob->sector_info_count - 1) {
-        if (addr >= FlashBlob->sector_info[index].AddrSector &&
-            addr < FlashBlob->sector_info[index + 1].AddrSector) {
-            break;
-        }
-        index++;
-    }
-    addr -= FlashBlob->sector_info[index].AddrSector;
-    if ((addr % FlashBlob->sector_info[index].szSector) == 0) {
+    const sector_info_t* info = flash_sector_info(addr);
+    addr = (addr & 0x07FFFFFF) - info->AddrSector;
+    if ((addr % info->szSector) == 0) {
         return 1;
     }
     return 0;
@@ -23,18 +23,28 @@ typedef enum {
     ERROR_WRITE,
     ERROR_SET_RDP,
     ERROR_VERIFY,
+    ERROR_BUSY,
+    ERROR_TIMEOUT,
     // Add new values here
 
     ERROR_COUNT
 } error_t;
 
-error_t target_flash_init(const program_target_t* prog, uint32_t flash_start);
-error_t target_flash_uninit(void);
-error_t target_flash_program_page(uint32_t addr, const uint8_t* buf, uint32_t size);
-error_t target_flash_erase_sector(uint32_t addr);
-error_t target_flash_erase_chip(void);
-error_t target_flash_set_rdp(void);
-error_t target_flash_verify(uint32_t addr, uint32_t size, uint32_t crc);
-uint8_t target_flash_sector_integer(uint32_t addr);
+error_t  target_flash_init(const program_target_t* prog, uint32_t flash_start, uint32_t ram_size);
+error_t  target_flash_poll(void);
+error_t  target_flash_sync(void);
+error_t  target_flash_uninit(void);
+error_t  target_flash_program_page(uint32_t addr, const uint8_t* buf, uint32_t size);
+error_t  target_flash_erase_sector(uint32_t addr);
+error_t  target_flash_erase_sector_start(uint32_t addr);
+error_t  target_flash_erase_range_start(uint32_t addr, uint32_t size);
+uint8_t  target_flash_erase_chip_faster(uint32_t addr, uint32_t size);
+error_t  target_flash_erase_chip(void);
+error_t  target_flash_set_rdp(void);
+error_t  target_flash_verify(uint32_t addr, uint32_t size, uint32_t crc);
+uint32_t target_flash_crc_capacity(void);
+error_t  target_flash_crc_table(uint32_t offset, const uint8_t* buf, uint32_t size);
+error_t  target_flash_crc_check(uint32_t addr, uint32_t size, uint32_t chunk, uint32_t offset, uint32_t* count);
+uint8_t  target_flash_sector_integer(uint32_t addr);
 
 #endif   // __SWD_FLASH_H__
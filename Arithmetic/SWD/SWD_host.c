@@ -7,6 +7,9 @@
 #include "DAP.h"
 #include "DAP_config.h"
 #include "debug_cm.h"
+#include "spi.h"
+
+#include <string.h>
 
 #define NVIC_Addr (0xe000e000)
 #define DBG_Addr  (0xe000edf0)
@@ -29,10 +32,33 @@
 #define MAX_SWD_RETRY 10
 #define MAX_TIMEOUT   1000000   // Timeout for syscalls on target
 
+#define SWD_CALIBRATE_WORDS 32   // 时钟校准的RAM测试字数
+
+// 系统调用返回后保持不变的寄存器 (R4-R11, SP)
+#define CORE_PRESERVED (0x00000FF0 | (1 << 13))
+
+// TAR自增只保证在1KB范围内有效
+#define TARGET_AUTO_INCREMENT_PAGE_SIZE (0x400)
+
+#define HALT_SLEEP_RATIO 3    // 预期耗时的3/4内不查询状态
+#define HALT_TIME_SLACK  10   // 超时判断的余量(ms), 覆盖SWD访问和滴答计数误差
+
+#define RECONNECT_STEP  100    // 重新连接的首次探测间隔(us)
+#define RECONNECT_LIMIT 8000   // 重新连接的探测间隔上限(us)
+
 // #define SCB_AIRCR_PRIGROUP_Pos              8
 // #define SCB_AIRCR_PRIGROUP_Msk             (7UL << SCB_AIRCR_PRIGROUP_Pos)
 
 static DAP_STATE dap_state;
+static SWD_QUEUE swd_queue;
+static uint8_t   swd_clock = SWD_CLOCK_DEFAULT;   // SWD时钟档位
+
+static DEBUG_STATE core_state;   // 最近写入的内核寄存器值
+static uint32_t    core_valid;   // core_state中有效的寄存器(bit16为xPSR)
+
+static HALT_TIMING halt_timing;   // 等待内核停止的查询计划
+
+extern uint32_t SysTick_Get(void);   // 获取系统滴答计数值
 
 /**
  * @brief  延时函数
@@ -48,6 +74,20 @@ void delaymS(uint32_t ms) {
     }
 }
 
+/**
+ * @brief  微秒延时函数
+ * @note
+ * @param  us: 延时的微秒数
+ * @retval None
+ */
+static void delayuS(uint32_t us) {
+    uint32_t cnt = SystemCoreClock / 4 / 1000000 * us;
+
+    for (uint32_t i = 0; i < cnt; i++) {
+        __NOP();
+    }
+}
+
 /**
  * @brief  将32位整数转换为字节数组
  * @note   按小端格式转换
@@ -95,9 +135,64 @@ int8_t swd_init(void) {
     DAP_Setup();
     PORT_SWD_SETUP();
 
+    // 覆盖DAP_Setup设置的默认时钟
+    if (swd_clock == SWD_CLOCK_SPI) {
+#if (SWD_SPI_PHY != 0)
+        SPI2_SwdInit(SWD_SPI_BAUD);
+        DAP_Data.fast_clock  = SWD_SPI_CLOCK;
+        DAP_Data.clock_delay = 1;
+#else
+        DAP_Data.fast_clock  = 1;
+        DAP_Data.clock_delay = 1;
+#endif
+    } else if (swd_clock != SWD_CLOCK_DEFAULT) {
+        DAP_Data.fast_clock  = (swd_clock == SWD_CLOCK_FAST) ? 1 : 0;
+        DAP_Data.clock_delay = (swd_clock == SWD_CLOCK_FAST) ? 1 : swd_clock;
+    }
+
     return 0;
 }
 
+/**
+ * @brief  设置SWD时钟档位
+ * @note   档位即SW_DP的时钟延时周期数，SWD_CLOCK_FAST使用无延时的快速传输，
+ *         SWD_CLOCK_SPI在快速传输基础上由SPI2移入读数据，
+ *         SWD_CLOCK_DEFAULT恢复DAP_DEFAULT_SWJ_CLOCK；设置在之后的swd_init中保持有效
+ * @param  clock: 时钟档位
+ * @retval None
+ */
+void swd_set_clock(uint8_t clock) {
+    swd_clock = clock;
+    swd_init();
+}
+
+/**
+ * @brief  获取在线的并行目标
+ * @note   多目标并行时，传输中应答或数据与其他目标不一致的目标会被移出；单目标时恒为1
+ * @param  None
+ * @retval 在线目标掩码(bit n对应目标n)
+ */
+uint32_t swd_gang_active(void) {
+#if (SWD_GANG_COUNT > 1)
+    return SWD_GangActive;
+#else
+    return 1;
+#endif
+}
+
+/**
+ * @brief  恢复全部并行目标
+ * @note   开始一轮新的烧录或重新检测目标前调用
+ * @param  None
+ * @retval None
+ */
+void swd_gang_reset(void) {
+#if (SWD_GANG_COUNT > 1)
+    SWD_GangActive = (1U << SWD_GANG_COUNT) - 1U;
+    SWD_GangMode   = SWD_GANG_FIRST;
+#endif
+}
+
 /**
  * @brief  关闭SWD接口
  * @note   关闭端口电源
@@ -172,258 +267,260 @@ int8_t swd_write_dp(uint8_t adr, uint32_t val) {
 }
 
 /**
- * @brief  读取访问端口寄存器
- * @note   读取AP寄存器的值
- * @param  adr: 寄存器地址
- * @param  val: 读取到的值
+ * @brief  执行队列中的全部SWD传输
+ * @note   AP写为投递写，AP读结果在下一次AP读或RDBUFF中返回；
+ *         每次传输只检查应答，含写操作的批次结束后读取一次CTRL/STAT检查粘滞错误
+ * @param  None
  * @retval 0: 成功, -1: 失败
  */
-int8_t swd_read_ap(uint32_t adr, uint32_t* val) {
-    uint8_t  tmp_in, ack;
-    uint8_t  tmp_out[4];
-    uint32_t tmp;
-    uint32_t apsel    = adr & 0xff000000;
-    uint32_t bank_sel = adr & APBANKSEL;
+static int8_t swd_queue_flush(void) {
+    SWD_QUEUE_ITEM* item;
+    uint32_t*       post  = NULL;   // 挂起的AP读数据目的地址
+    uint8_t         read  = 0;      // 存在挂起的AP读
+    uint8_t         write = 0;      // 存在投递的AP写
+    uint8_t         ack   = DAP_TRANSFER_OK;
+    uint32_t        i, n, req, status;
+    uint32_t*       buf;
+    uint32_t        abort = STKCMPCLR | STKERRCLR | WDERRCLR | ORUNERRCLR;
+
+    for (i = 0; (i < swd_queue.count) && (ack == DAP_TRANSFER_OK); i++) {
+        item = &swd_queue.item[i];
+        req  = item->req;
+        buf  = item->buf;
+
+        if ((req & (SWD_REG_AP | SWD_REG_R)) == (SWD_REG_AP | SWD_REG_R)) {
+            // AP读: 本次应答返回上一次AP读的数据
+            for (n = 0; n < item->count; n++) {
+                ack  = swd_transfer_retry(req, read ? post : NULL);
+                post = buf++;
+                read = 1;
+
+                if (ack != DAP_TRANSFER_OK) {
+                    break;
+                }
+            }
 
-    if (swd_write_dp(DP_SELECT, apsel | bank_sel) != 0) {
-        return -1;
+            continue;
+        }
+
+        if (read) {
+            // 取回挂起的AP读数据
+            ack  = swd_transfer_retry(SWD_REG_DP | SWD_REG_R | SWD_REG_ADR(DP_RDBUFF), post);
+            read = 0;
+
+            if (ack != DAP_TRANSFER_OK) {
+                break;
+            }
+        }
+
+        for (n = 0; n < item->count; n++) {
+            ack = swd_transfer_retry(req, buf);
+
+            if (ack != DAP_TRANSFER_OK) {
+                break;
+            }
+
+            if ((req & SWD_REG_R) == 0) {
+                buf++;
+            }
+        }
+
+        if ((req & (SWD_REG_AP | SWD_REG_R)) == SWD_REG_AP) {
+            write = 1;
+        }
     }
 
-    tmp_in = SWD_REG_AP | SWD_REG_R | SWD_REG_ADR(adr);
-    // first dummy read
-    swd_transfer_retry(tmp_in, (uint32_t*) tmp_out);
-    ack = swd_transfer_retry(tmp_in, (uint32_t*) tmp_out);
+    swd_queue.count = 0;
 
-    *val = 0;
-    tmp  = tmp_out[3];
-    *val |= (tmp << 24);
-    tmp = tmp_out[2];
-    *val |= (tmp << 16);
-    tmp = tmp_out[1];
-    *val |= (tmp << 8);
-    tmp = tmp_out[0];
-    *val |= (tmp << 0);
+    if ((ack == DAP_TRANSFER_OK) && (read || write)) {
+        // 取回最后一次AP读数据，或等待最后一次投递写完成
+        ack = swd_transfer_retry(SWD_REG_DP | SWD_REG_R | SWD_REG_ADR(DP_RDBUFF), read ? post : NULL);
+    }
 
-    return (ack == 0x01) ? 0 : -1;
+    if ((ack == DAP_TRANSFER_OK) && write) {
+        ack = swd_transfer_retry(SWD_REG_DP | SWD_REG_R | SWD_REG_ADR(DP_CTRL_STAT), &status);
+
+        if ((ack == DAP_TRANSFER_OK) && (status & (STICKYERR | STICKYORUN | WDATAERR))) {
+            ack = DAP_TRANSFER_FAULT;
+        }
+    }
+
+    if ((ack != DAP_TRANSFER_OK) || swd_queue.error) {
+        swd_queue.error = 0;
+        // 清除粘滞错误，并使缓存的SELECT/CSW失效
+        swd_transfer_retry(SWD_REG_DP | SWD_REG_W | SWD_REG_ADR(DP_ABORT), &abort);
+        dap_state.select = 0xffffffff;
+        dap_state.csw    = 0xffffffff;
+        core_valid       = 0;
+        return -1;
+    }
+
+    return 0;
 }
 
 /**
- * @brief  写入访问端口寄存器
- * @note   写入AP寄存器的值
- * @param  adr: 寄存器地址
- * @param  val: 要写入的值
- * @retval 0: 成功, -1: 失败
+ * @brief  SWD传输队列项入队
+ * @note   队列满时自动执行一次批量传输，错误在最终执行时统一返回
+ * @param  req: SWD请求
+ * @param  buf: 数据指针，为NULL时使用队列项内的data
+ * @param  data: 单次写入的数据
+ * @param  count: 连续传输的字数
+ * @retval None
  */
-int8_t swd_write_ap(uint32_t adr, uint32_t val) {
-    uint8_t  data[4];
-    uint8_t  req, ack;
-    uint32_t apsel    = adr & 0xff000000;
-    uint32_t bank_sel = adr & APBANKSEL;
+static void swd_queue_push(uint32_t req, uint32_t* buf, uint32_t data, uint32_t count) {
+    SWD_QUEUE_ITEM* item;
 
-    if (swd_write_dp(DP_SELECT, apsel | bank_sel) != 0) {
-        return -1;
+    if (swd_queue.count >= SWD_QUEUE_SIZE) {
+        if (swd_queue_flush() != 0) {
+            swd_queue.error = 1;
+        }
     }
 
-    switch (adr) {
-        case AP_CSW:
-            if (dap_state.csw == val) {
-                return 0;
-            }
+    item        = &swd_queue.item[swd_queue.count++];
+    item->req   = req;
+    item->data  = data;
+    item->count = count;
+    item->buf   = (buf != NULL) ? buf : &item->data;
+}
 
-            dap_state.csw = val;
-            break;
+/**
+ * @brief  队列选择AP与寄存器组
+ * @note   与缓存的SELECT值相同时不产生传输
+ * @param  adr: AP寄存器地址(含APSEL和APBANKSEL)
+ * @retval None
+ */
+static void swd_queue_select(uint32_t adr) {
+    uint32_t select = (adr & APSEL) | (adr & APBANKSEL);
 
-        default:
-            break;
+    if (dap_state.select != select) {
+        dap_state.select = select;
+        swd_queue_push(SWD_REG_DP | SWD_REG_W | SWD_REG_ADR(DP_SELECT), NULL, select, 1);
     }
+}
 
-    req = SWD_REG_AP | SWD_REG_W | SWD_REG_ADR(adr);
-    int2array(data, val, 4);
+/**
+ * @brief  队列写入AP寄存器
+ * @note   CSW与缓存值相同时不产生传输
+ * @param  adr: AP寄存器地址
+ * @param  val: 要写入的值
+ * @retval None
+ */
+static void swd_queue_write_ap(uint32_t adr, uint32_t val) {
+    swd_queue_select(adr);
 
-    if (swd_transfer_retry(req, (uint32_t*) data) != 0x01) {
-        return -1;
+    if (adr == AP_CSW) {
+        if (dap_state.csw == val) {
+            return;
+        }
+
+        dap_state.csw = val;
     }
 
-    req = SWD_REG_DP | SWD_REG_R | SWD_REG_ADR(DP_RDBUFF);
-    ack = swd_transfer_retry(req, NULL);
+    swd_queue_push(SWD_REG_AP | SWD_REG_W | SWD_REG_ADR(adr), NULL, val, 1);
+}
 
-    return (ack == 0x01) ? 0 : -1;
+/**
+ * @brief  队列读取AP寄存器
+ * @note   数据在批量传输执行后才有效
+ * @param  adr: AP寄存器地址
+ * @param  val: 读取到的值
+ * @retval None
+ */
+static void swd_queue_read_ap(uint32_t adr, uint32_t* val) {
+    swd_queue_select(adr);
+    swd_queue_push(SWD_REG_AP | SWD_REG_R | SWD_REG_ADR(adr), val, 0, 1);
+}
+
+/**
+ * @brief  读取访问端口寄存器
+ * @note   读取AP寄存器的值
+ * @param  adr: 寄存器地址
+ * @param  val: 读取到的值
+ * @retval 0: 成功, -1: 失败
+ */
+int8_t swd_read_ap(uint32_t adr, uint32_t* val) {
+    swd_queue_read_ap(adr, val);
+    return swd_queue_flush();
+}
+
+/**
+ * @brief  写入访问端口寄存器
+ * @note   写入AP寄存器的值
+ * @param  adr: 寄存器地址
+ * @param  val: 要写入的值
+ * @retval 0: 成功, -1: 失败
+ */
+int8_t swd_write_ap(uint32_t adr, uint32_t val) {
+    swd_queue_write_ap(adr, val);
+    return swd_queue_flush();
 }
 
 /**
  * @brief  写入32位字对齐数据块到目标内存
- * @note   使用地址自增模式，大小以字节为单位
+ * @note   使用地址自增模式，大小以字节为单位，数据块不能跨越1KB地址边界
  * @param  address: 目标地址
  * @param  data: 数据指针
  * @param  size: 数据大小（字节）
  * @retval 0: 成功, -1: 失败
  */
 static int8_t swd_write_block(uint32_t address, uint8_t* data, uint32_t size) {
-    uint8_t  tmp_in[4], req;
-    uint32_t size_in_words;
-    uint32_t i, ack;
-
     if (size == 0) {
         return -1;
     }
 
-    size_in_words = size / 4;
-
-    // CSW register
-    if (swd_write_ap(AP_CSW, CSW_VALUE | CSW_SIZE32) != 0) {
-        return -1;
-    }
-
-    // TAR write
-    req = SWD_REG_AP | SWD_REG_W | (1 << 2);
-    int2array(tmp_in, address, 4);
-
-    if (swd_transfer_retry(req, (uint32_t*) tmp_in) != 0x01) {
-        return -1;
-    }
-
-    // DRW write
-    req = SWD_REG_AP | SWD_REG_W | (3 << 2);
-
-    for (i = 0; i < size_in_words; i++) {
-        if (swd_transfer_retry(req, (uint32_t*) data) != 0x01) {
-            return -1;
-        }
+    swd_queue_write_ap(AP_CSW, CSW_VALUE | CSW_SIZE32);
+    swd_queue_write_ap(AP_TAR, address);
+    swd_queue_push(SWD_REG_AP | SWD_REG_W | SWD_REG_ADR(AP_DRW), (uint32_t*) data, 0, size / 4);
 
-        data += 4;
-    }
-
-    // dummy read
-    req = SWD_REG_DP | SWD_REG_R | SWD_REG_ADR(DP_RDBUFF);
-    ack = swd_transfer_retry(req, NULL);
-    return (ack == 0x01) ? 0 : -1;
+    return swd_queue_flush();
 }
 
 /**
  * @brief  从目标内存读取32位字对齐数据块
- * @note   使用地址自增模式，大小以字节为单位
+ * @note   使用地址自增模式，大小以字节为单位，数据块不能跨越1KB地址边界
  * @param  address: 目标地址
  * @param  data: 数据缓冲区指针
  * @param  size: 数据大小（字节）
  * @retval 0: 成功, -1: 失败
  */
 static int8_t swd_read_block(uint32_t address, uint8_t* data, uint32_t size) {
-    uint8_t  tmp_in[4], req, ack;
-    uint32_t size_in_words;
-    uint32_t i;
-
     if (size == 0) {
         return -1;
     }
 
-    size_in_words = size / 4;
-
-    if (swd_write_ap(AP_CSW, CSW_VALUE | CSW_SIZE32) != 0) {
-        return -1;
-    }
-
-    // TAR write
-    req = SWD_REG_AP | SWD_REG_W | AP_TAR;
-    int2array(tmp_in, address, 4);
+    swd_queue_write_ap(AP_CSW, CSW_VALUE | CSW_SIZE32);
+    swd_queue_write_ap(AP_TAR, address);
+    swd_queue_push(SWD_REG_AP | SWD_REG_R | SWD_REG_ADR(AP_DRW), (uint32_t*) data, 0, size / 4);
 
-    if (swd_transfer_retry(req, (uint32_t*) tmp_in) != DAP_TRANSFER_OK) {
-        return -1;
-    }
-
-    // read data
-    req = SWD_REG_AP | SWD_REG_R | AP_DRW;
-
-    // initiate first read, data comes back in next read
-    if (swd_transfer_retry(req, NULL) != 0x01) {
-        return -1;
-    }
-
-    for (i = 0; i < (size_in_words - 1); i++) {
-        if (swd_transfer_retry(req, (uint32_t*) data) != DAP_TRANSFER_OK) {
-            return -1;
-        }
-
-        data += 4;
-    }
-
-    // read last word
-    req = SWD_REG_DP | SWD_REG_R | SWD_REG_ADR(DP_RDBUFF);
-    ack = swd_transfer_retry(req, (uint32_t*) data);
-    return (ack == 0x01) ? 0 : -1;
+    return swd_queue_flush();
 }
 
 /**
  * @brief  读取目标内存数据
- * @note   读取单个32位字数据
+ * @note   读取单个32位字数据，访问宽度由已入队的CSW决定
  * @param  addr: 目标地址
  * @param  val: 读取到的值
  * @retval 0: 成功, -1: 失败
  */
 static int8_t swd_read_data(uint32_t addr, uint32_t* val) {
-    uint8_t  tmp_in[4];
-    uint8_t  tmp_out[4];
-    uint8_t  req, ack;
-    uint32_t tmp;
-    // put addr in TAR register
-    int2array(tmp_in, addr, 4);
-    req = SWD_REG_AP | SWD_REG_W | (1 << 2);
-
-    if (swd_transfer_retry(req, (uint32_t*) tmp_in) != 0x01) {
-        return -1;
-    }
+    swd_queue_write_ap(AP_TAR, addr);
+    swd_queue_read_ap(AP_DRW, val);
 
-    // read data
-    req = SWD_REG_AP | SWD_REG_R | (3 << 2);
-
-    if (swd_transfer_retry(req, (uint32_t*) tmp_out) != 0x01) {
-        return -1;
-    }
-
-    // dummy read
-    req  = SWD_REG_DP | SWD_REG_R | SWD_REG_ADR(DP_RDBUFF);
-    ack  = swd_transfer_retry(req, (uint32_t*) tmp_out);
-    *val = 0;
-    tmp  = tmp_out[3];
-    *val |= (tmp << 24);
-    tmp = tmp_out[2];
-    *val |= (tmp << 16);
-    tmp = tmp_out[1];
-    *val |= (tmp << 8);
-    tmp = tmp_out[0];
-    *val |= (tmp << 0);
-    return (ack == 0x01) ? 0 : -1;
+    return swd_queue_flush();
 }
 
 /**
  * @brief  写入目标内存数据
- * @note   写入单个32位字数据
+ * @note   写入单个32位字数据，访问宽度由已入队的CSW决定
  * @param  address: 目标地址
  * @param  data: 要写入的数据
  * @retval 0: 成功, -1: 失败
  */
 static int8_t swd_write_data(uint32_t address, uint32_t data) {
-    uint8_t tmp_in[4];
-    uint8_t req, ack;
-    // put addr in TAR register
-    int2array(tmp_in, address, 4);
-    req = SWD_REG_AP | SWD_REG_W | (1 << 2);
-
-    if (swd_transfer_retry(req, (uint32_t*) tmp_in) != 0x01) {
-        return -1;
-    }
-
-    // write data
-    int2array(tmp_in, data, 4);
-    req = SWD_REG_AP | SWD_REG_W | (3 << 2);
+    swd_queue_write_ap(AP_TAR, address);
+    swd_queue_write_ap(AP_DRW, data);
 
-    if (swd_transfer_retry(req, (uint32_t*) tmp_in) != 0x01) {
-        return -1;
-    }
-
-    // dummy read
-    req = SWD_REG_DP | SWD_REG_R | SWD_REG_ADR(DP_RDBUFF);
-    ack = swd_transfer_retry(req, NULL);
-    return (ack == 0x01) ? 0 : -1;
+    return swd_queue_flush();
 }
 
 /**
@@ -434,15 +531,9 @@ static int8_t swd_write_data(uint32_t address, uint32_t data) {
  * @retval 0: 成功, -1: 失败
  */
 static int8_t swd_read_word(uint32_t addr, uint32_t* val) {
-    if (swd_write_ap(AP_CSW, CSW_VALUE | CSW_SIZE32) != 0) {
-        return -1;
-    }
+    swd_queue_write_ap(AP_CSW, CSW_VALUE | CSW_SIZE32);
 
-    if (swd_read_data(addr, val) != 0) {
-        return -1;
-    }
-
-    return 0;
+    return swd_read_data(addr, val);
 }
 
 /**
@@ -453,15 +544,9 @@ static int8_t swd_read_word(uint32_t addr, uint32_t* val) {
  * @retval 0: 成功, -1: 失败
  */
 static int8_t swd_write_word(uint32_t addr, uint32_t val) {
-    if (swd_write_ap(AP_CSW, CSW_VALUE | CSW_SIZE32) != 0) {
-        return -1;
-    }
+    swd_queue_write_ap(AP_CSW, CSW_VALUE | CSW_SIZE32);
 
-    if (swd_write_data(addr, val) != 0) {
-        return -1;
-    }
-
-    return 0;
+    return swd_write_data(addr, val);
 }
 
 /**
@@ -474,9 +559,7 @@ static int8_t swd_write_word(uint32_t addr, uint32_t val) {
 static int8_t swd_read_byte(uint32_t addr, uint8_t* val) {
     uint32_t tmp;
 
-    if (swd_write_ap(AP_CSW, CSW_VALUE | CSW_SIZE8) != 0) {
-        return -1;
-    }
+    swd_queue_write_ap(AP_CSW, CSW_VALUE | CSW_SIZE8);
 
     if (swd_read_data(addr, &tmp) != 0) {
         return -1;
@@ -496,22 +579,15 @@ static int8_t swd_read_byte(uint32_t addr, uint8_t* val) {
 static int8_t swd_write_byte(uint32_t addr, uint8_t val) {
     uint32_t tmp;
 
-    if (swd_write_ap(AP_CSW, CSW_VALUE | CSW_SIZE8) != 0) {
-        return -1;
-    }
-
+    swd_queue_write_ap(AP_CSW, CSW_VALUE | CSW_SIZE8);
     tmp = val << ((addr & 0x03) << 3);
 
-    if (swd_write_data(addr, tmp) != 0) {
-        return -1;
-    }
-
-    return 0;
+    return swd_write_data(addr, tmp);
 }
 
 /**
  * @brief  从目标内存读取非对齐数据
- * @note   可读取任意地址和大小的数据，大小以字节为单位
+ * @note   可读取任意地址和大小的数据，大小以字节为单位，按TAR自增的1KB边界分块
  * @param  address: 目标地址
  * @param  data: 数据缓冲区指针
  * @param  size: 数据大小（字节）
@@ -533,7 +609,12 @@ int8_t swd_read_memory(uint32_t address, uint8_t* data, uint32_t size) {
 
     // Read word aligned blocks
     while (size > 3) {
-        n = size & 0xFFFFFFFC;   // Only count complete words remaining
+        // Limit to auto increment page size
+        n = TARGET_AUTO_INCREMENT_PAGE_SIZE - (address & (TARGET_AUTO_INCREMENT_PAGE_SIZE - 1));
+
+        if (size < n) {
+            n = size & 0xFFFFFFFC;   // Only count complete words remaining
+        }
 
         if (swd_read_block(address, data, n) != 0) {
             return -1;
@@ -560,7 +641,7 @@ int8_t swd_read_memory(uint32_t address, uint8_t* data, uint32_t size) {
 
 /**
  * @brief  向目标内存写入非对齐数据
- * @note   可写入任意地址和大小的数据，大小以字节为单位
+ * @note   可写入任意地址和大小的数据，大小以字节为单位，按TAR自增的1KB边界分块
  * @param  address: 目标地址
  * @param  data: 数据指针
  * @param  size: 数据大小（字节）
@@ -582,7 +663,12 @@ int8_t swd_write_memory(uint32_t address, uint8_t* data, uint32_t size) {
 
     // Write word aligned blocks
     while (size > 3) {
-        n = size & 0xFFFFFFFC;   // Only count complete words remaining
+        // Limit to auto increment page size
+        n = TARGET_AUTO_INCREMENT_PAGE_SIZE - (address & (TARGET_AUTO_INCREMENT_PAGE_SIZE - 1));
+
+        if (size < n) {
+            n = size & 0xFFFFFFFC;   // Only count complete words remaining
+        }
 
         if (swd_write_block(address, data, n) != 0) {
             return -1;
@@ -608,55 +694,99 @@ int8_t swd_write_memory(uint32_t address, uint8_t* data, uint32_t size) {
 }
 
 /**
- * @brief  写入调试状态到目标核心
- * @note   设置核心寄存器状态用于系统调用执行
+ * @brief  批量写入核心寄存器
+ * @note   通过MEM-AP的BD0~BD2投递DCRDR/DCRSR写序列，每次写DCRSR后排入一次DHCSR读取，
+ *         既隔开相邻两次传输，又记录每个寄存器写入后的S_REGRDY；任一寄存器未就绪时
+ *         (其后的写入可能已被丢弃) 回退到逐个写入并等待S_REGRDY
  * @param  state: 调试状态结构体指针
+ * @param  mask: 需要写入的寄存器(bit16为xPSR)
  * @retval 0: 成功, -1: 失败
  */
-int8_t swd_write_debug_state(DEBUG_STATE* state) {
-    uint32_t i, status;
-
-    if (swd_write_dp(DP_SELECT, 0) != 0) {
-        return -1;
+static int8_t swd_write_core_registers(DEBUG_STATE* state, uint32_t mask) {
+    uint32_t n, val, dhcsr[17] = {0};
+
+    // TAR指向DHCSR，BD0=DHCSR, BD1=DCRSR, BD2=DCRDR
+    swd_queue_write_ap(AP_CSW, CSW_VALUE | CSW_SIZE32);
+    swd_queue_write_ap(AP_TAR, DBG_Addr);
+    swd_queue_select(AP_BD0);
+
+    for (n = 0; n <= 16; n++) {
+        if (mask & (1 << n)) {
+            val = (n == 16) ? state->xpsr : state->r[n];
+            swd_queue_push(SWD_REG_AP | SWD_REG_W | SWD_REG_ADR(AP_BD2), NULL, val, 1);
+            swd_queue_push(SWD_REG_AP | SWD_REG_W | SWD_REG_ADR(AP_BD1), NULL, n | REGWnR, 1);
+            swd_queue_read_ap(AP_BD0, &dhcsr[n]);
+        }
     }
 
-    // R0, R1, R2, R3
-    for (i = 0; i < 4; i++) {
-        if (swd_write_core_register(i, state->r[i]) != 0) {
-            return -1;
+    if (swd_queue_flush() == 0) {
+        for (n = 0; n <= 16; n++) {
+            if ((mask & (1 << n)) && ((dhcsr[n] & S_REGRDY) == 0)) {
+                break;
+            }
         }
-    }
 
-    // R9
-    if (swd_write_core_register(9, state->r[9]) != 0) {
-        return -1;
+        if (n > 16) {
+            return 0;
+        }
     }
 
-    // R13, R14, R15
-    for (i = 13; i < 16; i++) {
-        if (swd_write_core_register(i, state->r[i]) != 0) {
-            return -1;
+    for (n = 0; n <= 16; n++) {
+        if (mask & (1 << n)) {
+            val = (n == 16) ? state->xpsr : state->r[n];
+
+            if (swd_write_core_register(n, val) != 0) {
+                return -1;
+            }
         }
     }
 
-    // xPSR
-    if (swd_write_core_register(16, state->xpsr) != 0) {
-        return -1;
-    }
+    return 0;
+}
 
-    if (swd_write_word(DBG_HCSR, DBGKEY | C_DEBUGEN) != 0) {
-        return -1;
+/**
+ * @brief  写入调试状态到目标核心
+ * @note   设置核心寄存器状态用于系统调用执行，与上次写入值相同的寄存器不再写入
+ * @param  state: 调试状态结构体指针
+ * @retval 0: 成功, -1: 失败
+ */
+int8_t swd_write_debug_state(DEBUG_STATE* state) {
+    static const uint8_t list[] = {0, 1, 2, 3, 9, 13, 14, 15, 16};   // R0~R3, R9, R13~R15, xPSR
+    uint32_t             i, n, val, mask = 0;
+
+    for (i = 0; i < sizeof(list); i++) {
+        n   = list[i];
+        val = (n == 16) ? state->xpsr : state->r[n];
+
+        if (((core_valid & (1 << n)) == 0) ||
+            (((n == 16) ? core_state.xpsr : core_state.r[n]) != val)) {
+            mask |= (1 << n);
+        }
     }
 
-    // check status
-    if (swd_read_dp(DP_CTRL_STAT, &status) != 0) {
-        return -1;
+    if (mask != 0) {
+        if (swd_write_core_registers(state, mask) != 0) {
+            core_valid = 0;
+            return -1;
+        }
+
+        for (n = 0; n < 16; n++) {
+            if (mask & (1 << n)) {
+                core_state.r[n] = state->r[n];
+            }
+        }
+
+        core_state.xpsr = state->xpsr;
+        core_valid |= mask;
     }
 
-    if (status & (STICKYERR | WDATAERR)) {
+    if (swd_write_word(DBG_HCSR, DBGKEY | C_DEBUGEN) != 0) {
+        core_valid = 0;
         return -1;
     }
 
+    // 内核开始运行，只有被调用者保存的寄存器在返回后保持不变
+    core_valid &= CORE_PRESERVED;
     return 0;
 }
 
@@ -693,6 +823,16 @@ int8_t swd_read_core_register(uint32_t n, uint32_t* val) {
         return -1;
     }
 
+    if (n <= 16) {
+        if (n == 16) {
+            core_state.xpsr = *val;
+        } else {
+            core_state.r[n] = *val;
+        }
+
+        core_valid |= (1 << n);
+    }
+
     return 0;
 }
 
@@ -706,6 +846,10 @@ int8_t swd_read_core_register(uint32_t n, uint32_t* val) {
 int8_t swd_write_core_register(uint32_t n, uint32_t val) {
     int i = 0, timeout = 100;
 
+    if (n <= 16) {
+        core_valid &= ~(1 << n);
+    }
+
     if (swd_write_word(DCRDR, val) != 0) {
         return -1;
     }
@@ -728,43 +872,144 @@ int8_t swd_write_core_register(uint32_t n, uint32_t val) {
     return -1;
 }
 
+/**
+ * @brief  设置等待内核停止的耗时参数
+ * @note   从调用时刻开始计时. 预期耗时的3/4内不访问总线, 之后从1ms起倍增查询间隔,
+ *         间隔上限为预期耗时的1/4. 超过最大耗时后停止内核并返回超时
+ * @param  typ: 预期耗时(ms), 为0时立即开始连续查询
+ * @param  max: 最大耗时(ms), 为0时不限时, 由MAX_TIMEOUT次总线查询兜底
+ * @retval None
+ */
+void swd_set_halt_timing(uint32_t typ, uint32_t max) {
+    halt_timing.start = SysTick_Get();
+    halt_timing.next  = halt_timing.start + typ * HALT_SLEEP_RATIO / 4;
+    halt_timing.max   = (max != 0) ? (max + HALT_TIME_SLACK) : 0;
+    halt_timing.step  = (typ != 0) ? 1 : 0;
+    halt_timing.limit = (typ >= 8) ? (typ / 4) : halt_timing.step;
+}
+
+/**
+ * @brief  按查询计划检查内核是否停止
+ * @note   未到查询时刻时不访问总线直接返回. 失败或超时时内核可能停在算法中途, 寄存器缓存全部作废
+ * @param  None
+ * @retval 0: 已停止, 1: 正在执行, -1: 失败, -2: 超时
+ */
+static int8_t swd_halt_check(void) {
+    uint32_t now = SysTick_Get();
+    uint32_t val;
+    int8_t   state;
+
+    if ((int32_t) (now - halt_timing.next) < 0) {
+        return 1;
+    }
+
+#if (SWD_GANG_COUNT > 1)
+    // 多目标时全部停止才算停止
+    SWD_GangMode = SWD_GANG_ALL;
+    state        = swd_read_word(DBG_HCSR, &val);
+    SWD_GangMode = SWD_GANG_FIRST;
+#else
+    state = swd_read_word(DBG_HCSR, &val);
+#endif
+
+    if (state != 0) {
+        core_valid = 0;
+        return -1;
+    }
+
+    if (val & S_HALT) {
+        return 0;
+    }
+
+    if ((halt_timing.max != 0) && ((now - halt_timing.start) > halt_timing.max)) {
+        // 超时, 停止内核防止算法继续操作Flash
+        swd_write_word(DBG_HCSR, DBGKEY | C_DEBUGEN | C_HALT);
+        core_valid = 0;
+        return -2;
+    }
+
+    halt_timing.next = now + halt_timing.step;
+    if (halt_timing.step < halt_timing.limit) {
+        halt_timing.step <<= 1;
+        if (halt_timing.step > halt_timing.limit) {
+            halt_timing.step = halt_timing.limit;
+        }
+    }
+
+    return 1;
+}
+
 /**
  * @brief  等待目标停止
- * @note   等待目标核心进入停止状态
+ * @note   等待目标核心进入停止状态, 查询节奏由swd_set_halt_timing设置
  * @param  None
- * @retval 0: 成功, -1: 失败
+ * @retval 0: 成功, -1: 失败, -2: 超时
  */
 int8_t swd_wait_until_halted(void) {
     // Wait for target to stop
-    uint32_t val, i, timeout = MAX_TIMEOUT;
+    uint32_t i;
+    int8_t   state;
 
-    for (i = 0; i < timeout; i++) {
-        if (swd_read_word(DBG_HCSR, &val) != 0) {
-            return -1;
+    for (i = 0; (halt_timing.max != 0) || (i < MAX_TIMEOUT);) {
+        // 未到查询时刻时不访问总线, 不计入查询次数
+        if ((int32_t) (SysTick_Get() - halt_timing.next) >= 0) {
+            i++;
         }
+        state = swd_halt_check();
 
-        if (val & S_HALT) {
-            return 0;
+        if (state != 1) {
+            return state;
         }
     }
 
+    core_valid = 0;
     return -1;
 }
 
 /**
- * @brief  执行Flash系统调用
- * @note   在目标核心上执行Flash算法函数并等待结果
+ * @brief  读取Flash系统调用返回值
+ * @note   多目标时对各目标的R0多数表决, 返回值与多数不一致的目标被移出
+ * @param  result: 系统调用返回值
+ * @retval 0: 成功, -1: 失败
+ */
+static int8_t swd_read_result(uint32_t* result) {
+    int8_t state;
+
+    if (swd_read_core_register(0, result) != 0) {
+        core_valid = 0;
+        return -1;
+    }
+
+#if (SWD_GANG_COUNT > 1)
+    // DCRDR中仍保存着R0, 以表决方式重读
+    SWD_GangMode = SWD_GANG_VOTE;
+    state        = swd_read_word(DCRDR, result);
+    SWD_GangMode = SWD_GANG_FIRST;
+#else
+    state = 0;
+#endif
+
+    if (state != 0) {
+        core_valid = 0;
+    }
+
+    return state;
+}
+
+/**
+ * @brief  启动Flash系统调用
+ * @note   设置寄存器并释放内核后立即返回，不等待算法函数执行结束
  * @param  sysCallParam: 系统调用参数
  * @param  entry: 入口点地址
  * @param  arg1: 参数1
  * @param  arg2: 参数2
  * @param  arg3: 参数3
  * @param  arg4: 参数4
- * @retval 系统调用返回值
+ * @retval 0: 成功, -1: 失败
  */
-int32_t swd_flash_syscall_exec(const program_syscall_t* sysCallParam, uint32_t entry, uint32_t arg1, uint32_t arg2, uint32_t arg3, uint32_t arg4) {
+int8_t swd_flash_syscall_start(const program_syscall_t* sysCallParam, uint32_t entry, uint32_t arg1, uint32_t arg2, uint32_t arg3, uint32_t arg4) {
     DEBUG_STATE state = {{0}, 0};
-    // Call flash algorithm function on target and wait for result.
+    // Call flash algorithm function on target.
     state.r[0]  = arg1;                          // R0: Argument 1
     state.r[1]  = arg2;                          // R1: Argument 2
     state.r[2]  = arg3;                          // R2: Argument 3
@@ -775,19 +1020,66 @@ int32_t swd_flash_syscall_exec(const program_syscall_t* sysCallParam, uint32_t e
     state.r[15] = entry;                         // PC: Entry Point
     state.xpsr  = 0x01000000;                    // xPSR: T = 1, ISR = 0
 
-    if (swd_write_debug_state(&state) != 0) {
-        return -1;
+    swd_set_halt_timing(0, 0);
+
+    return swd_write_debug_state(&state);
+}
+
+/**
+ * @brief  查询Flash系统调用状态
+ * @note   不阻塞，内核停在断点处时读取返回值
+ * @param  result: 系统调用返回值
+ * @retval 0: 已结束, 1: 正在执行, -1: 失败, -2: 超时
+ */
+int8_t swd_flash_syscall_poll(uint32_t* result) {
+    int8_t state = swd_halt_check();
+
+    if (state != 0) {
+        return state;
+    }
+
+    return swd_read_result(result);
+}
+
+/**
+ * @brief  等待Flash系统调用结束
+ * @note   等待内核停在断点处并读取返回值
+ * @param  result: 系统调用返回值
+ * @retval 0: 成功, -1: 失败, -2: 超时
+ */
+int8_t swd_flash_syscall_wait(uint32_t* result) {
+    int8_t state = swd_wait_until_halted();
+
+    if (state != 0) {
+        return state;
     }
 
-    if (swd_wait_until_halted() != 0) {
+    return swd_read_result(result);
+}
+
+/**
+ * @brief  执行Flash系统调用
+ * @note   在目标核心上执行Flash算法函数并等待结果
+ * @param  sysCallParam: 系统调用参数
+ * @param  entry: 入口点地址
+ * @param  arg1: 参数1
+ * @param  arg2: 参数2
+ * @param  arg3: 参数3
+ * @param  arg4: 参数4
+ * @retval 系统调用返回值
+ */
+int32_t swd_flash_syscall_exec(const program_syscall_t* sysCallParam, uint32_t entry, uint32_t arg1, uint32_t arg2, uint32_t arg3, uint32_t arg4) {
+    uint32_t r0;
+
+    if (swd_flash_syscall_start(sysCallParam, entry, arg1, arg2, arg3, arg4) != 0) {
         return -1;
     }
 
-    if (swd_read_core_register(0, &state.r[0]) != 0) {
+    if (swd_flash_syscall_wait(&r0) != 0) {
         return -1;
     }
 
-    return state.r[0];
+    return r0;
 }
 
 /**
@@ -845,10 +1137,10 @@ int8_t swd_read_idcode(uint32_t* id) {
 /**
  * @brief  JTAG到SWD转换
  * @note   执行从JTAG到SWD的转换序列
- * @param  None
+ * @param  id: 返回IDCODE, 可为NULL
  * @retval 0: 成功, -1: 失败
  */
-static int8_t JTAG2SWD() {
+static int8_t JTAG2SWD(uint32_t* id) {
     uint32_t tmp = 0;
 
     if (swd_reset() != 0) {
@@ -866,6 +1158,9 @@ static int8_t JTAG2SWD() {
     if (swd_read_idcode(&tmp) != 0) {
         return -1;
     }
+    if (id != NULL) {
+        *id = tmp;
+    }
 
     return 0;
 }
@@ -883,13 +1178,16 @@ int8_t swd_init_debug(void) {
     // init dap state with fake values
     dap_state.select = 0xffffffff;
     dap_state.csw    = 0xffffffff;
+    swd_queue.count  = 0;
+    swd_queue.error  = 0;
+    core_valid       = 0;
     swd_init();
 
     // call a target dependant function
     // this function can do several stuff before really initing the debug
     // target_before_init_debug();
 
-    if (JTAG2SWD() != 0) {
+    if (JTAG2SWD(NULL) != 0) {
         return -1;
     }
 
@@ -937,6 +1235,154 @@ int8_t swd_init_debug(void) {
 
     return 0;
 }
+
+/**
+ * @brief  探测目标
+ * @note   只发送线复位和读IDCODE, 不上电调试端口, 用于快速检测目标是否接入;
+ *         目标上电后默认处于JTAG模式, 因此仍需发送JTAG到SWD切换序列
+ * @param  id: 返回IDCODE
+ * @retval 0: 成功, -1: 失败
+ */
+int8_t swd_probe(uint32_t* id) {
+    swd_init();
+
+    return JTAG2SWD(id);
+}
+
+/**
+ * @brief  等待目标重新连接
+ * @note   目标复位或重载选项字节后调用. 每次用swd_probe探测调试端口, 不上电调试端口,
+ *         响应后才调用swd_init_debug完整初始化; 探测间隔从RECONNECT_STEP开始倍增到RECONNECT_LIMIT
+ * @param  addr: 就绪检查地址(字对齐), 能读取时认为目标就绪, 为0时只要求调试端口响应
+ * @param  max: 最长等待时间(ms)
+ * @param  time: 返回实际等待时间(ms), 可为NULL
+ * @retval 0: 成功, -1: 超时
+ */
+int8_t swd_reconnect(uint32_t addr, uint32_t max, uint32_t* time) {
+    uint32_t start = SysTick_Get();
+    uint32_t step  = RECONNECT_STEP;
+    uint32_t val;
+    int8_t   state = -1;
+
+    do {
+        if ((swd_probe(&val) == 0) &&
+            (swd_init_debug() == 0) &&
+            ((addr == 0) || (swd_read_memory(addr, (uint8_t*) &val, 4) == 0))) {
+            state = 0;
+            break;
+        }
+        delayuS(step);
+        step = (step * 2 < RECONNECT_LIMIT) ? (step * 2) : RECONNECT_LIMIT;
+    } while ((SysTick_Get() - start) < max);
+
+    if (time != NULL) {
+        *time = SysTick_Get() - start;
+    }
+    return state;
+}
+
+/**
+ * @brief  SWD时钟测试
+ * @note   读取IDCODE并对目标RAM进行两轮写入/回读
+ * @param  ram: 测试区RAM地址
+ * @param  idcode: 参考IDCODE
+ * @retval 0: 成功, -1: 失败
+ */
+static int8_t swd_clock_test(uint32_t ram, uint32_t idcode) {
+    uint32_t pattern[SWD_CALIBRATE_WORDS];
+    uint32_t readback[SWD_CALIBRATE_WORDS];
+    uint32_t i, round, tmp;
+
+    if ((swd_read_idcode(&tmp) != 0) || (tmp != idcode)) {
+        return -1;
+    }
+
+    for (round = 0; round < 2; round++) {
+        for (i = 0; i < SWD_CALIBRATE_WORDS; i++) {
+            if (round == 0) {
+                pattern[i] = (i & 1) ? 0xAAAAAAAA : 0x55555555;   // 相邻位翻转
+            } else {
+                pattern[i] = ~(ram + i * 4) ^ (0x01010101 << (i & 7));   // 地址相关
+            }
+        }
+
+        if (swd_write_memory(ram, (uint8_t*) pattern, sizeof(pattern)) != 0) {
+            return -1;
+        }
+
+        if (swd_read_memory(ram, (uint8_t*) readback, sizeof(readback)) != 0) {
+            return -1;
+        }
+
+        if (memcmp(pattern, readback, sizeof(pattern)) != 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief  校准SWD时钟
+ * @note   需在swd_init_debug成功后调用。从低速档位逐级提速测试，取最快通过档位的下一档作为安全余量
+ *         (最低档除外)；内核会被停止，测试区RAM内容会被改写
+ * @param  ram: 测试区RAM地址
+ * @param  clock: 校准得到的时钟档位
+ * @retval 0: 成功, -1: 失败
+ */
+int8_t swd_clock_calibrate(uint32_t ram, uint8_t* clock) {
+#if (SWD_SPI_PHY != 0)
+    static const uint8_t level[] = {8, 4, 2, 1, SWD_CLOCK_FAST, SWD_CLOCK_SPI};   // 由慢到快
+#else
+    static const uint8_t level[] = {8, 4, 2, 1, SWD_CLOCK_FAST};   // 由慢到快
+#endif
+    uint32_t             idcode;
+    int8_t               pass = -1;   // 最快的通过档位
+    uint8_t              i;
+
+    if (swd_read_idcode(&idcode) != 0) {
+        return -1;
+    }
+
+    // 停止内核，避免目标程序改写测试区
+    if (swd_write_word(DBG_HCSR, DBGKEY | C_DEBUGEN | C_HALT) != 0) {
+        return -1;
+    }
+
+    for (i = 0; i < sizeof(level); i++) {
+        swd_set_clock(level[i]);
+
+        if (swd_clock_test(ram, idcode) != 0) {
+            break;
+        }
+
+        pass = i;
+    }
+
+    if (pass < 0) {
+        swd_set_clock(SWD_CLOCK_DEFAULT);
+        swd_init_debug();
+        return -1;
+    }
+
+    // 回退一档作为安全余量
+    if (pass > 0) {
+        pass--;
+    }
+
+    swd_set_clock(level[pass]);
+
+    if (i < sizeof(level)) {
+        // 出现过失败: 重新建立连接
+        if (swd_init_debug() != 0) {
+            return -1;
+        }
+    }
+
+    *clock = level[pass];
+    return 0;
+}
+
 /*
 
 __attribute__((weak)) void swd_set_target_reset(uint8_t asserted)
@@ -951,6 +1397,8 @@ __attribute__((weak)) void swd_set_target_reset(uint8_t asserted)
  * @retval None
  */
 void swd_set_target_reset(uint8_t asserted) {
+    core_valid = 0;
+
     /* 本文件中对此函数的使用都是先 asserted=1 调用，延时后 asserted=0 调用，为了只调用一次所以只在第二次调用此函数时执行软件复位 */
     if (asserted == 0) {
         swd_write_word(0xE000ED0C, 0x05FA0004);   // 软件复位
@@ -1035,7 +1483,7 @@ int8_t swd_set_target_state_hw(TARGET_RESET_STATE state) {
             break;
 
         case DEBUG:
-            if (JTAG2SWD() != 0) {
+            if (JTAG2SWD(NULL) != 0) {
                 return -1;
             }
 
@@ -1174,7 +1622,7 @@ int8_t swd_set_target_state_sw(TARGET_RESET_STATE state) {
             break;
 
         case DEBUG:
-            if (JTAG2SWD() != 0) {
+            if (JTAG2SWD(NULL) != 0) {
                 return -1;
             }
 
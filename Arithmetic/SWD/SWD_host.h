@@ -5,6 +5,12 @@
 
 #include "flash_blob.h"
 
+#define SWD_QUEUE_SIZE 24   // 传输队列深度
+
+#define SWD_CLOCK_FAST    0x00   // 快速传输(无延时)
+#define SWD_CLOCK_SPI     0xFE   // 快速传输, 读数据段由SPI2移位
+#define SWD_CLOCK_DEFAULT 0xFF   // DAP默认时钟
+
 typedef enum {
     RESET_HOLD,      // Hold target in reset
     RESET_PROGRAM,   // Reset target and setup for flash programming.
@@ -21,6 +27,30 @@ typedef struct
     uint32_t csw;
 } DAP_STATE;
 
+typedef struct
+{
+    uint32_t* buf;     // 数据指针
+    uint32_t  data;    // 单次写入的数据
+    uint16_t  count;   // 连续传输的字数
+    uint8_t   req;     // SWD请求
+} SWD_QUEUE_ITEM;
+
+typedef struct
+{
+    SWD_QUEUE_ITEM item[SWD_QUEUE_SIZE];
+    uint8_t        count;   // 队列中的传输项数
+    uint8_t        error;   // 自动执行时发生过错误
+} SWD_QUEUE;
+
+typedef struct
+{
+    uint32_t start;   // 系统调用启动时刻(ms)
+    uint32_t next;    // 下一次查询DHCSR的时刻(ms)
+    uint32_t max;     // 最大耗时(ms), 为0时不限时
+    uint32_t step;    // 当前查询间隔(ms)
+    uint32_t limit;   // 查询间隔上限(ms)
+} HALT_TIMING;
+
 typedef struct
 {
     uint32_t r[16];
@@ -29,7 +59,11 @@ typedef struct
 
 int8_t  swd_init(void);
 int8_t  swd_off(void);
+void    swd_set_clock(uint8_t clock);
+int8_t  swd_clock_calibrate(uint32_t ram, uint8_t* clock);
 int8_t  swd_init_debug(void);
+int8_t  swd_probe(uint32_t* id);
+int8_t  swd_reconnect(uint32_t addr, uint32_t max, uint32_t* time);
 int8_t  swd_read_idcode(uint32_t* id);
 int8_t  swd_read_dp(uint8_t adr, uint32_t* val);
 int8_t  swd_write_dp(uint8_t adr, uint32_t val);
@@ -37,13 +71,20 @@ int8_t  swd_read_ap(uint32_t adr, uint32_t* val);
 int8_t  swd_write_ap(uint32_t adr, uint32_t val);
 int8_t  swd_read_memory(uint32_t address, uint8_t* data, uint32_t size);
 int8_t  swd_write_memory(uint32_t address, uint8_t* data, uint32_t size);
+int8_t  swd_flash_syscall_start(const program_syscall_t* sysCallParam, uint32_t entry, uint32_t arg1, uint32_t arg2, uint32_t arg3, uint32_t arg4);
+int8_t  swd_flash_syscall_poll(uint32_t* result);
+int8_t  swd_flash_syscall_wait(uint32_t* result);
 int32_t swd_flash_syscall_exec(const program_syscall_t* sysCallParam, uint32_t entry, uint32_t arg1, uint32_t arg2, uint32_t arg3, uint32_t arg4);
 void    swd_set_target_reset(uint8_t asserted);
 int8_t  swd_set_target_state_hw(TARGET_RESET_STATE state);
 int8_t  swd_set_target_state_sw(TARGET_RESET_STATE state);
 
+uint32_t swd_gang_active(void);
+void     swd_gang_reset(void);
+
 int8_t swd_write_debug_state(DEBUG_STATE* state);
 int8_t swd_wait_until_halted(void);
+void   swd_set_halt_timing(uint32_t typ, uint32_t max);
 int8_t swd_read_core_register(uint32_t n, uint32_t* val);
 int8_t swd_write_core_register(uint32_t n, uint32_t val);
 
@@ -12,10 +12,11 @@
  * 0x20000800 ├─────────────────┤
  *            │  Static Data    │  <- static_base (全局/静态变量)
  *            │     Area        │
+ *            │     Stack       │  <- stack_pointer (栈空间, 自0x20000C00向下增长)
  * 0x20000C00 ├─────────────────┤
- *            │     Stack       │  <- stack_pointer (栈空间)
- *            │   (grows down)  │
- *            │                 │
+ *            │ Program Buffer2 │  <- program_buffer2 (双缓冲数据缓冲区)
+ *            │  (1024 bytes)   │
+ * 0x20001000 ├─────────────────┤
  *            │ ............... │
  *
  */
@@ -86,6 +87,7 @@ const program_target_t _stm32f10x_1024_ = {
         0x20000C00,   // RSP  : 栈指针地址
     },
     0x20000400,           // 编程缓冲区地址
+    0x20000C00,           // 编程缓冲区2地址
     0x20000000,           // 算法代码起始地址
     sizeof(flash_code),   // 算法代码大小
     flash_code,           // 算法代码数据指针
@@ -93,4 +95,10 @@ const program_target_t _stm32f10x_1024_ = {
 
     sector_info,                                    // 扇区信息指针
     sizeof(sector_info) / sizeof(sector_info[0]),   // 扇区数量
+    {
+        {40, 80},   // EraseChip   : 全片擦除耗时(ms)
+        {10, 20},   // EraseSector : 扇区擦除耗时(ms/KB)
+        {27, 40},   // ProgramPage : 页编程耗时(ms/KB)
+        {7, 30},    // Verify      : 校验耗时(ms/KB)
+    },
 };
\ No newline at end of file
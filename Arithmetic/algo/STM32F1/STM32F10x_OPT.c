@@ -79,6 +79,7 @@ const program_target_t _stm32f10x_opt_ = {
         0x20000C00,   // RSP  : 栈指针地址
     },
     0x20000400,           // 编程缓冲区地址
+    0x00000000,           // 编程缓冲区2地址 (不使用)
     0x20000000,           // 算法代码起始地址
     sizeof(flash_code),   // 算法代码大小
     flash_code,           // 算法代码数据指针
@@ -86,4 +87,5 @@ const program_target_t _stm32f10x_opt_ = {
 
     sector_info,                                    // 扇区信息指针
     sizeof(sector_info) / sizeof(sector_info[0]),   // 扇区数量
+    {{0}},   // 操作耗时参数 (不限时)
 };
\ No newline at end of file
@@ -12,15 +12,16 @@
  * 0x20000800 ├─────────────────┤
  *            │  Static Data    │  <- static_base (全局/静态变量)
  *            │     Area        │
+ *            │     Stack       │  <- stack_pointer (栈空间, 自0x20000C00向下增长)
  * 0x20000C00 ├─────────────────┤
- *            │     Stack       │  <- stack_pointer (栈空间)
- *            │   (grows down)  │
- *            │                 │
+ *            │ Program Buffer2 │  <- program_buffer2 (双缓冲数据缓冲区)
+ *            │  (1024 bytes)   │
+ * 0x20001000 ├─────────────────┤
  *            │ ............... │
  *
  */
 
-// Flash programming algorithm code
+// Flash programming algorithm code, x32并行(PSIZE=10, 2.7V~3.6V)
 // Functions:
 //   GetSecNum    @ +0x0005 (size: 28 bytes)
 //   Init         @ +0x0021 (size: 50 bytes)
@@ -40,10 +41,10 @@ static const uint32_t flash_code[] = {
     0x694060C2, 0xD4080681, 0xF2454851, 0x60025255,  // +0x0034
     0x60412106, 0x73FFF640, 0x20006083, 0x484D4770,  // +0x0044
     0xF0416801, 0x60014100, 0x47702000, 0x4A48484A,  // +0x0054
-    0xF0416841, 0x60410104, 0xF4416841, 0x60413180,  // +0x0064
+    0xF4416841, 0x60417101, 0xF4416841, 0x60413180,  // +0x0064
     0xF64AE002, 0x601121AA, 0x03D96803, 0x6842D4F9,  // +0x0074
     0x0204F022, 0x20006042, 0xB5804770, 0xFFB8F7FF,  // +0x0084
-    0x680A493D, 0x02F0F042, 0x2302600A, 0x00C0604B,  // +0x0094
+    0x680A493D, 0x02F0F042, 0x4B3F600A, 0x00C0604B,  // +0x0094
     0xF000684A, 0x431000F8, 0x4A356048, 0xF4406848,  // +0x00A4
     0x60483080, 0xF64AE002, 0x601020AA, 0x03D8680B,  // +0x00B4
     0x684AD4F9, 0x0202F022, 0x6808604A, 0x0FF0F010,  // +0x00C4
@@ -59,7 +60,7 @@ static const uint32_t flash_code[] = {
     0xF04F6812, 0x404530FF, 0xD00142AA, 0xBDE04618,  // +0x0164
     0xBDE018C8, 0x40023C00, 0x45670123, 0xCDEF89AB,  // +0x0174
     0x40003000, 0x40023C10, 0x40023C0C, 0xEDB88320,  // +0x0184
-    0x47702000, 0x00000000,                          // +0x0194
+    0x47702000, 0x00000000, 0x00000202,              // +0x0194
     // clang-format on
 };
 
@@ -85,6 +86,7 @@ const program_target_t _stm32f4xx_1024_ = {
         0x20000C00,   // RSP  : 栈指针地址
     },
     0x20000400,           // 编程缓冲区地址
+    0x20000C00,           // 编程缓冲区2地址
     0x20000000,           // 算法代码起始地址
     sizeof(flash_code),   // 算法代码大小
     flash_code,           // 算法代码数据指针
@@ -92,4 +94,10 @@ const program_target_t _stm32f4xx_1024_ = {
 
     sector_info,                                    // 扇区信息指针
     sizeof(sector_info) / sizeof(sector_info[0]),   // 扇区数量
+    {
+        {8000, 16000},    // EraseChip   : 全片擦除耗时(ms)
+        {8, 32},          // EraseSector : 扇区擦除耗时(ms/KB)
+        {4, 26},          // ProgramPage : 页编程耗时(ms/KB)
+        {4, 20},          // Verify      : 校验耗时(ms/KB)
+    },
 };
\ No newline at end of file
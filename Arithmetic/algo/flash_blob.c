@@ -1,4 +1,6 @@
 #include "flash_blob.h"
+#include "SPI_Flash.h"
+#include "flash_package.h"
 #include "stdlib.h"
 #include "string.h"
 
@@ -12,137 +14,306 @@ extern const program_target_t _stm32f10x_512_;
 
 extern const program_target_t _stm32f2xx_opt_;
 extern const program_target_t _stm32f2xx_1024_;
+extern const program_target_t _stm32f2xx_1024_x8_;
+extern const program_target_t _stm32f2xx_1024_x16_;
+extern const program_target_t _stm32f2xx_1024_x64_;
 
 extern const program_target_t _stm32f3xx_opt_;
 extern const program_target_t _stm32f3xx_512_;
 
 extern const program_target_t _stm32f40xxx_41xxx_opt_;
 extern const program_target_t _stm32f4xx_1024_;
+extern const program_target_t _stm32f4xx_1024_x8_;
+extern const program_target_t _stm32f4xx_1024_x16_;
+extern const program_target_t _stm32f4xx_1024_x64_;
 
+// 选项字状态寄存器 {地址, 掩码, 未开启读写保护且为默认选项字时的值}, 地址为0的项不检查
+#define STM32F0XX_64_OPT_CHECK                                                      \
+    {                                                                               \
+        {0x4002201C, 0xFFFF7706, 0xFFFF7700}, /* FLASH_OBR: RDPRT, USER, DATA0/1 */ \
+        {0x40022020, 0x0000FFFF, 0x0000FFFF}, /* FLASH_WRPR: WRP0/1 */              \
+    }
+#define STM32F0XX_256_OPT_CHECK                                                     \
+    {                                                                               \
+        {0x4002201C, 0xFFFF7706, 0xFFFF7700}, /* FLASH_OBR: RDPRT, USER, DATA0/1 */ \
+        {0x40022020, 0xFFFFFFFF, 0xFFFFFFFF}, /* FLASH_WRPR: WRP0~3 */              \
+    }
+#define STM32F10X_OPT_CHECK                                                         \
+    {                                                                               \
+        {0x4002201C, 0x03FFFC1E, 0x03FFFC1C}, /* FLASH_OBR: RDPRT, USER, DATA0/1 */ \
+        {0x40022020, 0xFFFFFFFF, 0xFFFFFFFF}, /* FLASH_WRPR: WRP0~3 */              \
+    }
+#define STM32F2XX_F4XX_OPT_CHECK                                                          \
+    {                                                                                     \
+        {0x40023C14, 0x0FFFFFEC, 0x0FFFAAEC}, /* FLASH_OPTCR: nWRP, RDP, USER, BOR_LEV */ \
+    }
+#define STM32F3XX_OPT_CHECK                                                         \
+    {                                                                               \
+        {0x4002201C, 0xFFFF3706, 0xFFFF3700}, /* FLASH_OBR: RDPRT, USER, DATA0/1 */ \
+        {0x40022020, 0xFFFFFFFF, 0xFFFFFFFF}, /* FLASH_WRPR: WRP0~3 */              \
+    }
+
+// 按DevId升序排列, 查找时二分
 const FlashBlobList_t FlashBlobList[] = {
     {
-        /* STM32F03x */
-        .DevId         = 0x444,              // 设备ID
-        .Name          = "STM32F03x",        // 产品名称
-        .FlashSizeAddr = 0x1FFFF7CC,         // Flash大小寄存器地址
-        .FlashSize     = {16, 64},           // Flash大小范围
-        .prog_flash    = &_stm32f0xx_64_,    // Flash编程算法
-        .prog_opt      = &_stm32f0xx_opt_,   // 选项字编程算法
+        /* STM32F10x_MD: 中容量产品 64K~128K */
+        .DevId         = 0x410,                 // 设备ID
+        .Name          = "STM32F10x_MD",        // 产品名称
+        .FlashSizeAddr = 0x1FFFF7E0,            // Flash大小寄存器地址
+        .FlashSize     = {64, 128},             // Flash大小范围
+        .RamSize       = 10,                    // SRAM大小(KB)
+        .ReconnectTime = 2000,                  // 重新连接最长等待时间(ms)
+        .OptCheck      = STM32F10X_OPT_CHECK,   // 选项字状态检查
+        .prog_flash    = &_stm32f10x_128_,      // Flash编程算法
+        .prog_opt      = &_stm32f10x_opt_,      // 选项字编程算法
     },
     {
-        /* STM32F04x */
-        .DevId         = 0x445,              // 设备ID
-        .Name          = "STM32F04x",        // 产品名称
-        .FlashSizeAddr = 0x1FFFF7CC,         // Flash大小寄存器地址
-        .FlashSize     = {16, 64},           // Flash大小范围
-        .prog_flash    = &_stm32f0xx_64_,    // Flash编程算法
-        .prog_opt      = &_stm32f0xx_opt_,   // 选项字编程算法
+        /* STM32F2xx x32 */
+        .DevId         = 0x411,                      // 产品ID
+        .Name          = "STM32F2xx",                // 产品名称
+        .FlashSizeAddr = 0x1FFF7A22,                 // Flash大小寄存器地址
+        .FlashSize     = {128, 1024},                // Flash大小范围
+        .RamSize       = 64,                         // SRAM大小(KB)
+        .Parallelism   = 32,                         // 编程并行位数
+        .ReconnectTime = 2000,                       // 重新连接最长等待时间(ms)
+        .OptCheck      = STM32F2XX_F4XX_OPT_CHECK,   // 选项字状态检查
+        .prog_flash    = &_stm32f2xx_1024_,          // Flash编程算法
+        .prog_opt      = &_stm32f2xx_opt_,           // 选项字编程算法
     },
     {
-        /* STM32F05x */
-        .DevId         = 0x440,              // 设备ID
-        .Name          = "STM32F05x",        // 产品名称
-        .FlashSizeAddr = 0x1FFFF7CC,         // Flash大小寄存器地址
-        .FlashSize     = {16, 64},           // Flash大小范围
-        .prog_flash    = &_stm32f0xx_64_,    // Flash编程算法
-        .prog_opt      = &_stm32f0xx_opt_,   // 选项字编程算法
+        /* STM32F2xx x8 */
+        .DevId         = 0x411,                      // 产品ID
+        .Name          = "STM32F2xx",                // 产品名称
+        .FlashSizeAddr = 0x1FFF7A22,                 // Flash大小寄存器地址
+        .FlashSize     = {128, 1024},                // Flash大小范围
+        .RamSize       = 64,                         // SRAM大小(KB)
+        .Parallelism   = 8,                          // 编程并行位数
+        .ReconnectTime = 2000,                       // 重新连接最长等待时间(ms)
+        .OptCheck      = STM32F2XX_F4XX_OPT_CHECK,   // 选项字状态检查
+        .prog_flash    = &_stm32f2xx_1024_x8_,       // Flash编程算法
+        .prog_opt      = &_stm32f2xx_opt_,           // 选项字编程算法
     },
     {
-        /* STM32F07x */
-        .DevId         = 0x448,                 // 设备ID
-        .Name          = "STM32F07x",           // 产品名称
-        .FlashSizeAddr = 0x1FFFF7CC,            // Flash大小寄存器地址
-        .FlashSize     = {64, 256},             // Flash大小范围
-        .prog_flash    = &_stm32f0xx_256_2k_,   // Flash编程算法
-        .prog_opt      = &_stm32f0xx_opt_,      // 选项字编程算法
+        /* STM32F2xx x16 */
+        .DevId         = 0x411,                      // 产品ID
+        .Name          = "STM32F2xx",                // 产品名称
+        .FlashSizeAddr = 0x1FFF7A22,                 // Flash大小寄存器地址
+        .FlashSize     = {128, 1024},                // Flash大小范围
+        .RamSize       = 64,                         // SRAM大小(KB)
+        .Parallelism   = 16,                         // 编程并行位数
+        .ReconnectTime = 2000,                       // 重新连接最长等待时间(ms)
+        .OptCheck      = STM32F2XX_F4XX_OPT_CHECK,   // 选项字状态检查
+        .prog_flash    = &_stm32f2xx_1024_x16_,      // Flash编程算法
+        .prog_opt      = &_stm32f2xx_opt_,           // 选项字编程算法
     },
     {
-        /* STM32F09x */
-        .DevId         = 0x442,                 // 设备ID
-        .Name          = "STM32F09x",           // 产品名称
-        .FlashSizeAddr = 0x1FFFF7CC,            // Flash大小寄存器地址
-        .FlashSize     = {64, 256},             // Flash大小范围
-        .prog_flash    = &_stm32f0xx_256_2k_,   // Flash编程算法
-        .prog_opt      = &_stm32f0xx_opt_,      // 选项字编程算法
+        /* STM32F2xx x64 */
+        .DevId         = 0x411,                      // 产品ID
+        .Name          = "STM32F2xx",                // 产品名称
+        .FlashSizeAddr = 0x1FFF7A22,                 // Flash大小寄存器地址
+        .FlashSize     = {128, 1024},                // Flash大小范围
+        .RamSize       = 64,                         // SRAM大小(KB)
+        .Parallelism   = 64,                         // 编程并行位数
+        .ReconnectTime = 2000,                       // 重新连接最长等待时间(ms)
+        .OptCheck      = STM32F2XX_F4XX_OPT_CHECK,   // 选项字状态检查
+        .prog_flash    = &_stm32f2xx_1024_x64_,      // Flash编程算法
+        .prog_opt      = &_stm32f2xx_opt_,           // 选项字编程算法
     },
     {
         /* STM32F10x_LD: 小容量产品 16K~32K */
-        .DevId         = 0x412,              // 设备ID
-        .Name          = "STM32F10x_LD",     // 产品名称
-        .FlashSizeAddr = 0x1FFFF7E0,         // Flash大小寄存器地址
-        .FlashSize     = {16, 32},           // Flash大小范围
-        .prog_flash    = &_stm32f10x_128_,   // Flash编程算法
-        .prog_opt      = &_stm32f10x_opt_,   // 选项字编程算法
+        .DevId         = 0x412,                 // 设备ID
+        .Name          = "STM32F10x_LD",        // 产品名称
+        .FlashSizeAddr = 0x1FFFF7E0,            // Flash大小寄存器地址
+        .FlashSize     = {16, 32},              // Flash大小范围
+        .RamSize       = 4,                     // SRAM大小(KB)
+        .ReconnectTime = 2000,                  // 重新连接最长等待时间(ms)
+        .OptCheck      = STM32F10X_OPT_CHECK,   // 选项字状态检查
+        .prog_flash    = &_stm32f10x_128_,      // Flash编程算法
+        .prog_opt      = &_stm32f10x_opt_,      // 选项字编程算法
     },
     {
-        /* STM32F10x_MD: 中容量产品 64K~128K */
-        .DevId         = 0x410,              // 设备ID
-        .Name          = "STM32F10x_MD",     // 产品名称
-        .FlashSizeAddr = 0x1FFFF7E0,         // Flash大小寄存器地址
-        .FlashSize     = {64, 128},          // Flash大小范围
-        .prog_flash    = &_stm32f10x_128_,   // Flash编程算法
-        .prog_opt      = &_stm32f10x_opt_,   // 选项字编程算法
+        /* STM32F405xx/07xx STM32F415xx/17xx x32 */
+        .DevId         = 0x413,                                 // 产品ID
+        .Name          = "STM32F405xx/07xx STM32F415xx/17xx",   // 产品名称
+        .FlashSizeAddr = 0x1FFF7A22,                            // Flash大小寄存器地址
+        .FlashSize     = {128, 1024},                           // Flash大小范围
+        .RamSize       = 128,                                   // SRAM大小(KB)
+        .Parallelism   = 32,                                    // 编程并行位数
+        .ReconnectTime = 2000,                                  // 重新连接最长等待时间(ms)
+        .OptCheck      = STM32F2XX_F4XX_OPT_CHECK,              // 选项字状态检查
+        .prog_flash    = &_stm32f4xx_1024_,                     // Flash编程算法
+        .prog_opt      = &_stm32f40xxx_41xxx_opt_,              // 选项字编程算法
+    },
+    {
+        /* STM32F405xx/07xx STM32F415xx/17xx x8 */
+        .DevId         = 0x413,                                 // 产品ID
+        .Name          = "STM32F405xx/07xx STM32F415xx/17xx",   // 产品名称
+        .FlashSizeAddr = 0x1FFF7A22,                            // Flash大小寄存器地址
+        .FlashSize     = {128, 1024},                           // Flash大小范围
+        .RamSize       = 128,                                   // SRAM大小(KB)
+        .Parallelism   = 8,                                     // 编程并行位数
+        .ReconnectTime = 2000,                                  // 重新连接最长等待时间(ms)
+        .OptCheck      = STM32F2XX_F4XX_OPT_CHECK,              // 选项字状态检查
+        .prog_flash    = &_stm32f4xx_1024_x8_,                  // Flash编程算法
+        .prog_opt      = &_stm32f40xxx_41xxx_opt_,              // 选项字编程算法
+    },
+    {
+        /* STM32F405xx/07xx STM32F415xx/17xx x16 */
+        .DevId         = 0x413,                                 // 产品ID
+        .Name          = "STM32F405xx/07xx STM32F415xx/17xx",   // 产品名称
+        .FlashSizeAddr = 0x1FFF7A22,                            // Flash大小寄存器地址
+        .FlashSize     = {128, 1024},                           // Flash大小范围
+        .RamSize       = 128,                                   // SRAM大小(KB)
+        .Parallelism   = 16,                                    // 编程并行位数
+        .ReconnectTime = 2000,                                  // 重新连接最长等待时间(ms)
+        .OptCheck      = STM32F2XX_F4XX_OPT_CHECK,              // 选项字状态检查
+        .prog_flash    = &_stm32f4xx_1024_x16_,                 // Flash编程算法
+        .prog_opt      = &_stm32f40xxx_41xxx_opt_,              // 选项字编程算法
+    },
+    {
+        /* STM32F405xx/07xx STM32F415xx/17xx x64 */
+        .DevId         = 0x413,                                 // 产品ID
+        .Name          = "STM32F405xx/07xx STM32F415xx/17xx",   // 产品名称
+        .FlashSizeAddr = 0x1FFF7A22,                            // Flash大小寄存器地址
+        .FlashSize     = {128, 1024},                           // Flash大小范围
+        .RamSize       = 128,                                   // SRAM大小(KB)
+        .Parallelism   = 64,                                    // 编程并行位数
+        .ReconnectTime = 2000,                                  // 重新连接最长等待时间(ms)
+        .OptCheck      = STM32F2XX_F4XX_OPT_CHECK,              // 选项字状态检查
+        .prog_flash    = &_stm32f4xx_1024_x64_,                 // Flash编程算法
+        .prog_opt      = &_stm32f40xxx_41xxx_opt_,              // 选项字编程算法
     },
     {
         /* STM32F10x_HD: 高容量产品 256K~512K */
-        .DevId         = 0x414,              // 产品ID
-        .Name          = "STM32F10x_HD",     // 产品名称
-        .FlashSizeAddr = 0x1FFFF7E0,         // Flash大小寄存器地址
-        .FlashSize     = {256, 512},         // Flash大小范围
-        .prog_flash    = &_stm32f10x_512_,   // Flash编程算法
-        .prog_opt      = &_stm32f10x_opt_,   // 选项字编程算法
+        .DevId         = 0x414,                 // 产品ID
+        .Name          = "STM32F10x_HD",        // 产品名称
+        .FlashSizeAddr = 0x1FFFF7E0,            // Flash大小寄存器地址
+        .FlashSize     = {256, 512},            // Flash大小范围
+        .RamSize       = 32,                    // SRAM大小(KB)
+        .ReconnectTime = 2000,                  // 重新连接最长等待时间(ms)
+        .OptCheck      = STM32F10X_OPT_CHECK,   // 选项字状态检查
+        .prog_flash    = &_stm32f10x_512_,      // Flash编程算法
+        .prog_opt      = &_stm32f10x_opt_,      // 选项字编程算法
     },
     {
         /* STM32F10x_XL: 互联型产品 */
-        .DevId         = 0x418,              // 产品ID
-        .Name          = "STM32F10x_XL",     // 产品名称
-        .FlashSizeAddr = 0x1FFFF7E0,         // Flash大小寄存器地址
-        .FlashSize     = {128, 256},         // Flash大小范围
-        .prog_flash    = &_stm32f10x_512_,   // Flash编程算法
-        .prog_opt      = &_stm32f10x_opt_,   // 选项字编程算法
+        .DevId         = 0x418,                 // 产品ID
+        .Name          = "STM32F10x_XL",        // 产品名称
+        .FlashSizeAddr = 0x1FFFF7E0,            // Flash大小寄存器地址
+        .FlashSize     = {128, 256},            // Flash大小范围
+        .RamSize       = 64,                    // SRAM大小(KB)
+        .ReconnectTime = 2000,                  // 重新连接最长等待时间(ms)
+        .OptCheck      = STM32F10X_OPT_CHECK,   // 选项字状态检查
+        .prog_flash    = &_stm32f10x_512_,      // Flash编程算法
+        .prog_opt      = &_stm32f10x_opt_,      // 选项字编程算法
     },
     {
-        /* STM32F2xx */
-        .DevId         = 0x411,               // 产品ID
-        .Name          = "STM32F2xx",         // 产品名称
-        .FlashSizeAddr = 0x1FFF7A22,          // Flash大小寄存器地址
-        .FlashSize     = {128, 1024},         // Flash大小范围
-        .prog_flash    = &_stm32f2xx_1024_,   // Flash编程算法
-        .prog_opt      = &_stm32f2xx_opt_,    // 选项字编程算法
+        /* STM32F3xx */
+        .DevId         = 0x432,                 // 产品ID
+        .Name          = "STM32F3xx",           // 产品名称
+        .FlashSizeAddr = 0x1FFFF7CC,            // Flash大小寄存器地址
+        .FlashSize     = {16, 512},             // Flash大小范围
+        .RamSize       = 16,                    // SRAM大小(KB)
+        .ReconnectTime = 1000,                  // 重新连接最长等待时间(ms)
+        .OptCheck      = STM32F3XX_OPT_CHECK,   // 选项字状态检查
+        .prog_flash    = &_stm32f3xx_512_,      // Flash编程算法
+        .prog_opt      = &_stm32f3xx_opt_,      // 选项字编程算法
     },
     {
-        /* STM32F3xx */
-        .DevId         = 0x432,              // 产品ID
-        .Name          = "STM32F3xx",        // 产品名称
-        .FlashSizeAddr = 0x1FFFF7CC,         // Flash大小寄存器地址
-        .FlashSize     = {16, 512},          // Flash大小范围
-        .prog_flash    = &_stm32f3xx_512_,   // Flash编程算法
-        .prog_opt      = &_stm32f3xx_opt_,   // 选项字编程算法
+        /* STM32F05x */
+        .DevId         = 0x440,                    // 设备ID
+        .Name          = "STM32F05x",              // 产品名称
+        .FlashSizeAddr = 0x1FFFF7CC,               // Flash大小寄存器地址
+        .FlashSize     = {16, 64},                 // Flash大小范围
+        .RamSize       = 8,                        // SRAM大小(KB)
+        .ReconnectTime = 1000,                     // 重新连接最长等待时间(ms)
+        .OptCheck      = STM32F0XX_64_OPT_CHECK,   // 选项字状态检查
+        .prog_flash    = &_stm32f0xx_64_,          // Flash编程算法
+        .prog_opt      = &_stm32f0xx_opt_,         // 选项字编程算法
     },
     {
-        /* STM32F405xx/07xx STM32F415xx/17xx */
-        .DevId         = 0x413,                                 // 产品ID
-        .Name          = "STM32F405xx/07xx STM32F415xx/17xx",   // 产品名称
-        .FlashSizeAddr = 0x1FFF7A22,                            // Flash大小寄存器地址
-        .FlashSize     = {128, 1024},                           // Flash大小范围
-        .prog_flash    = &_stm32f4xx_1024_,                          // Flash编程算法
-        .prog_opt      = &_stm32f40xxx_41xxx_opt_,              // 选项字编程算法
+        /* STM32F09x */
+        .DevId         = 0x442,                     // 设备ID
+        .Name          = "STM32F09x",               // 产品名称
+        .FlashSizeAddr = 0x1FFFF7CC,                // Flash大小寄存器地址
+        .FlashSize     = {64, 256},                 // Flash大小范围
+        .RamSize       = 32,                        // SRAM大小(KB)
+        .ReconnectTime = 1000,                      // 重新连接最长等待时间(ms)
+        .OptCheck      = STM32F0XX_256_OPT_CHECK,   // 选项字状态检查
+        .prog_flash    = &_stm32f0xx_256_2k_,       // Flash编程算法
+        .prog_opt      = &_stm32f0xx_opt_,          // 选项字编程算法
+    },
+    {
+        /* STM32F03x */
+        .DevId         = 0x444,                    // 设备ID
+        .Name          = "STM32F03x",              // 产品名称
+        .FlashSizeAddr = 0x1FFFF7CC,               // Flash大小寄存器地址
+        .FlashSize     = {16, 64},                 // Flash大小范围
+        .RamSize       = 4,                        // SRAM大小(KB)
+        .ReconnectTime = 1000,                     // 重新连接最长等待时间(ms)
+        .OptCheck      = STM32F0XX_64_OPT_CHECK,   // 选项字状态检查
+        .prog_flash    = &_stm32f0xx_64_,          // Flash编程算法
+        .prog_opt      = &_stm32f0xx_opt_,         // 选项字编程算法
+    },
+    {
+        /* STM32F04x */
+        .DevId         = 0x445,                    // 设备ID
+        .Name          = "STM32F04x",              // 产品名称
+        .FlashSizeAddr = 0x1FFFF7CC,               // Flash大小寄存器地址
+        .FlashSize     = {16, 64},                 // Flash大小范围
+        .RamSize       = 6,                        // SRAM大小(KB)
+        .ReconnectTime = 1000,                     // 重新连接最长等待时间(ms)
+        .OptCheck      = STM32F0XX_64_OPT_CHECK,   // 选项字状态检查
+        .prog_flash    = &_stm32f0xx_64_,          // Flash编程算法
+        .prog_opt      = &_stm32f0xx_opt_,         // 选项字编程算法
+    },
+    {
+        /* STM32F07x */
+        .DevId         = 0x448,                     // 设备ID
+        .Name          = "STM32F07x",               // 产品名称
+        .FlashSizeAddr = 0x1FFFF7CC,                // Flash大小寄存器地址
+        .FlashSize     = {64, 256},                 // Flash大小范围
+        .RamSize       = 16,                        // SRAM大小(KB)
+        .ReconnectTime = 1000,                      // 重新连接最长等待时间(ms)
+        .OptCheck      = STM32F0XX_256_OPT_CHECK,   // 选项字状态检查
+        .prog_flash    = &_stm32f0xx_256_2k_,       // Flash编程算法
+        .prog_opt      = &_stm32f0xx_opt_,          // 选项字编程算法
     },
 };
 
 /**
  * @brief  根据设备ID和Flash大小获取对应的Flash编程算法
- * @note
+ * @note   区分编程并行位数的系列返回对应位数的算法. 导入的算法包优先于内置算法,
+ *         内置列表按DevId二分查找第一个匹配项后依次比较
  * @param  id: 设备ID
- * @param  flash_size: Flash大小
+ * @param  flash_size: Flash大小, 为0时不区分
+ * @param  parallelism: 编程并行位数(8/16/32/64), 为0时不区分
  * @retval 指向FlashBlobList_t的指针，如果未找到则返回NULL
  */
-FlashBlobList_t* FlashBlob_Get(uint16_t id, uint16_t flash_size) {
-    for (size_t i = 0; i < sizeof(FlashBlobList) / sizeof(FlashBlobList[0]); i++) {
-        if ((FlashBlobList[i].DevId == id) &&
-            ((flash_size == 0) ||
+FlashBlobList_t* FlashBlob_Get(uint16_t id, uint16_t flash_size, uint8_t parallelism) {
+    FlashBlobList_t* blob = FlashPackage_Get(id, flash_size, parallelism);
+    size_t           low  = 0;
+    size_t           high = sizeof(FlashBlobList) / sizeof(FlashBlobList[0]);
+    size_t           mid;
+
+    if (blob != NULL) {
+        return blob;
+    }
+    while (low < high) {
+        mid = (low + high) / 2;
+        if (FlashBlobList[mid].DevId < id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    for (size_t i = low; (i < sizeof(FlashBlobList) / sizeof(FlashBlobList[0])) && (FlashBlobList[i].DevId == id); i++) {
+        if (((flash_size == 0) ||
              ((flash_size >= FlashBlobList[i].FlashSize[0]) &&
-              (flash_size <= FlashBlobList[i].FlashSize[1])))) {
+              (flash_size <= FlashBlobList[i].FlashSize[1]))) &&
+            ((parallelism == 0) ||
+             (FlashBlobList[i].Parallelism == 0) ||
+             (FlashBlobList[i].Parallelism == parallelism))) {
             return (FlashBlobList_t*) &FlashBlobList[i];
         }
     }
@@ -151,11 +322,12 @@ FlashBlobList_t* FlashBlob_Get(uint16_t id, uint16_t flash_size) {
 
 /**
  * @brief  获取算法列表字符串
- * @note
+ * @note   内置算法之后追加导入的算法包
  * @param  str: 字符串缓冲区
+ * @param  size: 缓冲区大小
  * @retval None
  */
-void FlashBlob_ListStr(char* str) {
+void FlashBlob_ListStr(char* str, uint32_t size) {
     *str = '\0';   // 清空字符串
     for (size_t i = 0; i < sizeof(FlashBlobList) / sizeof(FlashBlobList[0]); i++) {
         if (strstr(str, FlashBlobList[i].Name) != NULL) {
@@ -165,4 +337,22 @@ void FlashBlob_ListStr(char* str) {
         strcat(str, FlashBlobList[i].Name);   // 添加设备名称
         strcat(str, "\r\n");                  // 添加换行符
     }
-}
\ No newline at end of file
+    FlashPackage_ListStr(str, size);
+}
+
+/**
+ * @brief  读取算法代码
+ * @note   内置算法从片内Flash复制, 导入的算法包从SPI Flash读取
+ * @param  prog: 编程算法
+ * @param  offset: 代码内偏移
+ * @param  buf: 缓冲区
+ * @param  size: 读取大小
+ * @retval None
+ */
+void FlashBlob_Read(const program_target_t* prog, uint32_t offset, void* buf, uint32_t size) {
+    if (prog->algo_blob != NULL) {
+        memcpy(buf, (const uint8_t*) prog->algo_blob + offset, size);
+    } else {
+        SPI_FLASH_Read(buf, prog->algo_addr + offset, size);
+    }
+}
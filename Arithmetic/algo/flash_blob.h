@@ -14,6 +14,18 @@ typedef struct {
     unsigned long AddrSector;   // 扇区地址
 } sector_info_t;
 
+typedef struct {
+    uint16_t typ;   // 典型耗时(ms)
+    uint16_t max;   // 最大耗时(ms), 为0时不限时
+} program_time_t;
+
+typedef struct {
+    program_time_t erase_chip;     // 全片擦除耗时
+    program_time_t erase_sector;   // 扇区擦除耗时(每KB)
+    program_time_t program_page;   // 页编程耗时(每KB)
+    program_time_t verify;         // 校验耗时(每KB)
+} program_timing_t;
+
 typedef struct {
     const uint32_t          init;                  // 初始化函数地址
     const uint32_t          uninit;                // 反初始化函数地址
@@ -24,25 +36,57 @@ typedef struct {
     const uint32_t          verify;                // 验证函数地址
     const program_syscall_t sys_call_s;            // 系统调用参数
     const uint32_t          program_buffer;        // 编程缓冲区地址
+    const uint32_t          program_buffer2;       // 编程缓冲区2地址 (双缓冲, 为0时不使用)
     const uint32_t          algo_start;            // 算法代码起始地址
     const uint32_t          algo_size;             // 算法代码大小
-    const uint32_t*         algo_blob;             // 算法代码数据指针
+    const uint32_t*         algo_blob;             // 算法代码数据指针 (为NULL时从SPI Flash的algo_addr读取)
     const uint32_t          program_buffer_size;   // 编程缓冲区大小
     const sector_info_t*    sector_info;           // 扇区信息
     const uint32_t          sector_info_count;     // 扇区数量
+    const program_timing_t  timing;                // 操作耗时参数
+    const uint32_t          algo_addr;             // 算法代码在SPI Flash中的地址 (导入的算法包)
 } program_target_t;
 
+typedef struct {
+    program_time_t crc_check;     // 分块CRC校验耗时(每KB)
+    program_time_t blank_check;   // 空白检查耗时(每KB)
+} program_common_timing_t;
+
+typedef struct {
+    const uint32_t                crc_check;    // 分块CRC校验函数地址
+    const uint32_t                blank_check;  // 空白检查函数地址
+    const uint32_t                erase_range;  // 多扇区擦除函数地址
+    const uint32_t                algo_start;   // 辅助算法起始地址
+    const uint32_t                algo_size;    // 辅助算法代码大小
+    const uint32_t*               algo_blob;    // 辅助算法代码数据指针
+    const program_common_timing_t timing;       // 操作耗时参数
+} program_common_t;
+
+typedef struct {
+    uint32_t addr;    // 选项字状态寄存器地址, 为0时不检查
+    uint32_t mask;    // 比较掩码
+    uint32_t value;   // 未开启读写保护且为默认选项字时的值
+} option_check_t;
+
 typedef struct {
     const uint16_t DevId;           // 设备ID (12位)
     const char*    Name;            // 设备名称
     const uint32_t FlashSizeAddr;   // Flash大小寄存器地址
     const uint16_t FlashSize[2];    // Flash大小范围
+    const uint16_t RamSize;         // SRAM大小(KB, 取系列最小值), 用于放置编程缓冲区
+    const uint8_t  Parallelism;     // 编程并行位数(8/16/32/64), 为0时不区分
+    const uint16_t ReconnectTime;   // 选项字重载后等待重新连接的最长时间(ms), 为0时取默认值
+
+    const option_check_t OptCheck[2];   // 选项字状态检查, 均未设置时每次烧录都复位选项字
 
     const program_target_t* prog_flash;   // Flash编程算法
     const program_target_t* prog_opt;     // 选项字编程算法
 } FlashBlobList_t;
 
-FlashBlobList_t* FlashBlob_Get(uint16_t id, uint16_t flash_size);
-void             FlashBlob_ListStr(char* str);
+extern const program_common_t flash_common;
+
+FlashBlobList_t* FlashBlob_Get(uint16_t id, uint16_t flash_size, uint8_t parallelism);
+void             FlashBlob_ListStr(char* str, uint32_t size);
+void             FlashBlob_Read(const program_target_t* prog, uint32_t offset, void* buf, uint32_t size);
 
 #endif
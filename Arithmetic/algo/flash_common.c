@@ -0,0 +1,65 @@
+#include "flash_blob.h"
+
+/*
+ * 通用辅助算法, 与Flash编程算法一起下载到同一个算法槽中, 不访问Flash控制器.
+ * 仅使用Thumb-1指令, Cortex-M0/M3/M4均可执行, 代码位置无关.
+ *
+ * 0x20000000 ┌─────────────────┐
+ *            │ Flash Algorithm │  <- 编程算法 (不超过512字节)
+ * 0x20000200 ├─────────────────┤
+ *            │  Common Helper  │  <- algo_start (通用辅助算法)
+ *            ├─────────────────┤
+ *            │ ............... │
+ * 0x200003F8 ├─────────────────┤
+ *            │   Resident Tag  │  <- 驻留标记
+ * 0x20000400 └─────────────────┘
+ *
+ * 函数说明:
+ *   CrcCheck(addr, size, table, chunk)
+ *     按chunk字节分块计算CRC32(与CRC32_Update一致)并与table中的值比较,
+ *     返回第一个不一致的块序号, 全部一致时返回块数
+ *   BlankCheck(addr, size)
+ *     检查size字节(16的整数倍)是否全部为0xFF, 是返回0, 否则返回1
+ *   EraseRange(list, count, erase_sector)
+ *     按list中的count段{地址, 扇区大小, 扇区数}逐个扇区调用编程算法的erase_sector,
+ *     已为空白的扇区跳过. 全部成功返回0, 否则返回erase_sector的返回值
+ */
+
+// Common helper code
+// Functions:
+//   CrcCheck     @ +0x0000 (size: 74 bytes)
+//   BlankCheck   @ +0x004A (size: 30 bytes)
+//   EraseRange   @ +0x0068 (size: 56 bytes)
+
+static const uint32_t common_code[] = {
+    // clang-format off
+    0x2400B5F0, 0x2900A626, 0x461FD01D, 0xD2004299,  // +0x0000
+    0x1BC9460F, 0x2500B40A, 0x780143ED, 0x404D3001,  // +0x0010
+    0x0E890729, 0x092D5871, 0x0729404D, 0x58710E89,  // +0x0020
+    0x404D092D, 0xD1F03F01, 0xBC0A43ED, 0x42BDCA80,  // +0x0030
+    0x3401D101, 0x0020E7DF, 0xB570BDF0, 0x43D22200,  // +0x0040
+    0xD3073910, 0x4023C878, 0x4033402B, 0xD0F74293,  // +0x0050
+    0xBD702001, 0xBD702000, 0x0004B5F0, 0x0016000D,  // +0x0060
+    0xD0132D00, 0x00386827, 0xF7FF6861, 0x2800FFE6,  // +0x0070
+    0x0038D003, 0x280047B0, 0x6861D109, 0x68A1187F,  // +0x0080
+    0x60A13901, 0x340CD1EF, 0xE7E93D01, 0xBDF02000,  // +0x0090
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,  // +0x00A0
+    0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,  // +0x00B0
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,  // +0x00C0
+    0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,  // +0x00D0
+    // clang-format on
+};
+
+// Common helper configuration
+const program_common_t flash_common = {
+    0x20000201,            // CrcCheck
+    0x2000024B,            // BlankCheck
+    0x20000269,            // EraseRange
+    0x20000200,            // 辅助算法起始地址
+    sizeof(common_code),   // 辅助算法代码大小
+    common_code,           // 辅助算法代码数据指针
+    {
+        {1, 10},   // CrcCheck  : 分块CRC校验耗时(ms/KB)
+        {0, 10},   // BlankCheck: 空白检查耗时(ms/KB), 不足1ms, 连续查询
+    },
+};
@@ -0,0 +1,669 @@
+/**
+ * @file    flash_package.c
+ * @brief   运行时导入的Flash编程算法包
+ * @note    U盘算法目录下每个算法包由一个JSON描述文件和Flash/选项字两个算法代码文件组成.
+ *          导入时算法包记录和算法代码依次写入SPI Flash算法区, 算法区首扇区保存按DevId排序的索引.
+ *          算法目录内容不变时(目录签名一致)直接使用已有索引, 不重复导入.
+ *
+ * 算法区布局 :
+ *
+ * SPI_FLASH_ALGO_ADDRESS ┌─────────────────┐
+ *                        │  Index Header   │  <- package_index_t
+ *                        ├ ─ ─ ─ ─ ─ ─ ─ ─ ┤
+ *                        │  Index Entries  │  <- package_entry_t[], 按DevId升序
+ *               + 0x1000 ├─────────────────┤
+ *                        │     Record      │  <- package_record_t
+ *                        ├ ─ ─ ─ ─ ─ ─ ─ ─ ┤
+ *                        │  Flash Algo     │  <- Flash编程算法代码
+ *                        ├ ─ ─ ─ ─ ─ ─ ─ ─ ┤
+ *                        │   Opt Algo      │  <- 选项字编程算法代码
+ *                        ├─────────────────┤
+ *                        │      ...        │
+ */
+#include "flash_package.h"
+
+#include "FlashLayout.h"
+#include "SPI_Flash.h"
+#include "cJSON.h"
+#include "crc.h"
+#include "heap.h"
+#include "stdlib.h"
+#include "string.h"
+
+#define PACKAGE_INDEX_MAGIC (0x49474C41)   // 索引标记 'ALGI'
+#define PACKAGE_MAX         16             // 算法包数量上限
+#define PACKAGE_SECTOR_MAX  8              // 每个算法的扇区信息组数上限
+#define PACKAGE_NAME_SIZE   24             // 设备名称长度上限(含结束符)
+#define PACKAGE_PATH_MAX    128            // 文件路径长度上限(含结束符)
+#define PACKAGE_FILE_MAX    32             // 算法代码文件名长度上限(含结束符)
+#define PACKAGE_CODE_MAX    0x1000         // 算法代码大小上限
+
+#define PACKAGE_ALIGN(size) (((size) + 3) & ~3)   // 按字对齐
+
+typedef struct {
+    uint32_t Magic;       // 索引标记
+    uint32_t Signature;   // 算法目录签名
+    uint32_t Count;       // 算法包数量
+    uint32_t Crc;         // 索引项CRC32
+} package_index_t;
+
+typedef struct {
+    uint16_t DevId;          // 设备ID
+    uint16_t FlashSize[2];   // Flash大小范围
+    uint8_t  Parallelism;    // 编程并行位数, 为0时不区分
+    uint8_t  Reserved;       // 保留
+    uint32_t Record;         // 算法包记录地址
+} package_entry_t;
+
+typedef struct {
+    uint32_t          entry[7];                          // 函数入口地址(init/uninit/erase_chip/erase_sector/program_page/set_rdp/verify), 为0时不支持
+    program_syscall_t sys_call_s;                        // 系统调用参数
+    uint32_t          program_buffer;                    // 编程缓冲区地址
+    uint32_t          program_buffer2;                   // 编程缓冲区2地址
+    uint32_t          program_buffer_size;               // 编程缓冲区大小
+    uint32_t          algo_start;                        // 算法代码起始地址
+    uint32_t          algo_size;                         // 算法代码大小
+    uint32_t          algo_addr;                         // 算法代码在SPI Flash中的地址
+    uint32_t          sector_info_count;                 // 扇区信息组数
+    sector_info_t     sector_info[PACKAGE_SECTOR_MAX];   // 扇区信息
+    program_timing_t  timing;                            // 操作耗时参数
+} package_algo_t;
+
+typedef struct {
+    char           Name[PACKAGE_NAME_SIZE];   // 设备名称
+    uint16_t       DevId;                     // 设备ID
+    uint16_t       RamSize;                   // SRAM大小(KB)
+    uint16_t       FlashSize[2];              // Flash大小范围
+    uint32_t       FlashSizeAddr;             // Flash大小寄存器地址
+    uint8_t        Parallelism;               // 编程并行位数
+    uint8_t        Reserved;                  // 保留
+    uint16_t       ReconnectTime;             // 重新连接最长等待时间(ms)
+    option_check_t OptCheck[2];               // 选项字状态检查
+    package_algo_t Algo[2];                   // [0]: Flash编程算法, [1]: 选项字编程算法
+} package_record_t;
+
+static uint32_t         PackageCount = 0;   // 索引中的算法包数量
+static uint32_t         PackageErase = 0;   // 导入时下一个未擦除的扇区地址
+static char             PackageName[PACKAGE_NAME_SIZE];
+static sector_info_t    PackageSector[2][PACKAGE_SECTOR_MAX];
+static program_target_t PackageTarget[2];
+static FlashBlobList_t  PackageBlob;
+
+/**
+ * @brief  读取索引项
+ * @param  index: 索引项序号
+ * @param  entry: 索引项
+ * @retval None
+ */
+static void package_read_entry(uint32_t index, package_entry_t* entry) {
+    SPI_FLASH_Read(entry,
+                   SPI_FLASH_ALGO_ADDRESS + sizeof(package_index_t) + index * sizeof(package_entry_t),
+                   sizeof(package_entry_t));
+}
+
+/**
+ * @brief  顺序写入算法区
+ * @note   数据所在的扇区第一次写入前擦除
+ * @param  buf: 数据
+ * @param  addr: 写入地址
+ * @param  size: 数据大小
+ * @retval None
+ */
+static void package_write(void* buf, uint32_t addr, uint32_t size) {
+    while (PackageErase < addr + size) {
+        SPI_FLASH_Erase(PackageErase);
+        PackageErase += W25QXX_BLOCK_SIZE;
+    }
+    SPI_FLASH_Write(buf, addr, size);
+}
+
+/**
+ * @brief  读取JSON数值
+ * @note   支持数字和字符串("0x"开头为十六进制)
+ * @param  item: JSON项
+ * @param  value: 数值
+ * @retval 1: 成功, 0: 失败
+ */
+static uint8_t package_json_value(cJSON* item, uint32_t* value) {
+    char* end;
+
+    if (cJSON_IsNumber(item)) {
+        *value = (uint32_t) cJSON_GetNumberValue(item);
+        return 1;
+    }
+    if (cJSON_IsString(item)) {
+        *value = strtoul(item->valuestring, &end, 0);
+        return (end != item->valuestring) && (*end == '\0');
+    }
+    return 0;
+}
+
+/**
+ * @brief  读取JSON对象中的数值
+ * @param  obj: JSON对象
+ * @param  name: 键名
+ * @param  value: 数值
+ * @retval 1: 成功, 0: 失败
+ */
+static uint8_t package_json_u32(cJSON* obj, const char* name, uint32_t* value) {
+    return package_json_value(cJSON_GetObjectItem(obj, name), value);
+}
+
+/**
+ * @brief  读取JSON数值数组 [a, b, ...]
+ * @param  item: JSON项
+ * @param  value: 数值数组
+ * @param  count: 数组长度
+ * @retval 1: 成功, 0: 失败
+ */
+static uint8_t package_json_array(cJSON* item, uint32_t* value, uint8_t count) {
+    if (cJSON_GetArraySize(item) != count) {
+        return 0;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        if (package_json_value(cJSON_GetArrayItem(item, i), &value[i]) == 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief  解析算法描述
+ * @note   入口、断点、静态数据、栈和缓冲区均为相对算法起始地址的偏移, 入口偏移包含Thumb位
+ * @param  obj: 算法描述JSON对象
+ * @param  algo: 算法记录
+ * @retval 算法代码文件名, 描述无效时返回NULL
+ */
+static const char* package_parse_algo(cJSON* obj, package_algo_t* algo) {
+    static const char* const entry_name[] = {"init", "uninit", "eraseChip", "eraseSector", "programPage", "setRDP", "verify"};
+    static const char* const time_name[]  = {"eraseChip", "eraseSector", "programPage", "verify"};
+    program_time_t* const    time[]       = {&algo->timing.erase_chip, &algo->timing.erase_sector, &algo->timing.program_page, &algo->timing.verify};
+    cJSON*                   file         = cJSON_GetObjectItem(obj, "file");
+    cJSON*                   item         = NULL;
+    uint32_t                 pair[2];
+
+    if ((cJSON_IsString(file) == 0) ||
+        (package_json_u32(obj, "start", &algo->algo_start) == 0) ||
+        (package_json_u32(obj, "init", &algo->entry[0]) == 0) ||
+        (package_json_u32(obj, "breakpoint", &algo->sys_call_s.breakpoint) == 0) ||
+        (package_json_u32(obj, "staticBase", &algo->sys_call_s.static_base) == 0) ||
+        (package_json_u32(obj, "stackPointer", &algo->sys_call_s.stack_pointer) == 0) ||
+        (package_json_u32(obj, "buffer", &algo->program_buffer) == 0) ||
+        (package_json_u32(obj, "bufferSize", &algo->program_buffer_size) == 0)) {
+        return NULL;
+    }
+    algo->sys_call_s.breakpoint += algo->algo_start;
+    algo->sys_call_s.static_base += algo->algo_start;
+    algo->sys_call_s.stack_pointer += algo->algo_start;
+    algo->program_buffer += algo->algo_start;
+    if (package_json_u32(obj, "buffer2", &algo->program_buffer2) != 0) {
+        algo->program_buffer2 += algo->algo_start;
+    }
+    for (uint8_t i = 0; i < sizeof(entry_name) / sizeof(entry_name[0]); i++) {
+        if (package_json_u32(obj, entry_name[i], &algo->entry[i]) != 0) {
+            algo->entry[i] += algo->algo_start;
+        }
+    }
+
+    // 扇区信息 [[扇区大小, 起始偏移], ...]
+    item                    = cJSON_GetObjectItem(obj, "sectors");
+    algo->sector_info_count = cJSON_GetArraySize(item);
+    if ((algo->sector_info_count == 0) || (algo->sector_info_count > PACKAGE_SECTOR_MAX)) {
+        return NULL;
+    }
+    for (uint8_t i = 0; i < algo->sector_info_count; i++) {
+        if (package_json_array(cJSON_GetArrayItem(item, i), pair, 2) == 0) {
+            return NULL;
+        }
+        algo->sector_info[i].szSector   = pair[0];
+        algo->sector_info[i].AddrSector = pair[1];
+    }
+
+    // 操作耗时参数 {"eraseChip": [典型, 最大], ...}, 缺省时不限时
+    item = cJSON_GetObjectItem(obj, "timing");
+    for (uint8_t i = 0; i < sizeof(time_name) / sizeof(time_name[0]); i++) {
+        if (package_json_array(cJSON_GetObjectItem(item, time_name[i]), pair, 2) != 0) {
+            time[i]->typ = pair[0];
+            time[i]->max = pair[1];
+        }
+    }
+
+    return file->valuestring;
+}
+
+/**
+ * @brief  复制算法代码文件到算法区
+ * @param  file: 文件对象
+ * @param  path: 文件路径
+ * @param  addr: 写入地址, 返回时指向下一个空闲地址
+ * @param  buf: 缓冲区
+ * @param  size: 缓冲区大小
+ * @retval 算法代码大小, 失败时返回0
+ */
+static uint32_t package_copy(FIL* file, const char* path, uint32_t* addr, char* buf, uint32_t size) {
+    uint32_t length = 0;
+    uint32_t offset = 0;
+    UINT     r_cnt  = 0;
+
+    if (f_open(file, path, FA_READ) != FR_OK) {
+        return 0;
+    }
+    length = f_size(file);
+    if ((length < sizeof(uint32_t)) ||
+        (length > PACKAGE_CODE_MAX) ||
+        ((length % sizeof(uint32_t)) != 0) ||
+        (*addr + length > SPI_FLASH_ALGO_ADDRESS + SPI_FLASH_ALGO_SIZE)) {
+        f_close(file);
+        return 0;
+    }
+    while ((offset < length) &&
+           (f_read(file, buf, size, &r_cnt) == FR_OK) &&
+           (r_cnt != 0)) {
+        package_write(buf, *addr + offset, r_cnt);
+        offset += r_cnt;
+    }
+    f_close(file);
+    *addr += PACKAGE_ALIGN(length);   // 中途失败时也保留已写入的空间
+
+    return (offset == length) ? length : 0;
+}
+
+/**
+ * @brief  导入一个算法包
+ * @param  file: 文件对象
+ * @param  path: 描述文件路径, 前dir_len个字符为算法目录
+ * @param  dir_len: 算法目录路径长度(含'/')
+ * @param  buf: 缓冲区, 用于读取描述文件和复制算法代码
+ * @param  size: 缓冲区大小
+ * @param  addr: 写入地址, 返回时指向下一个空闲地址
+ * @param  entry: 索引项
+ * @retval 1: 成功, 0: 失败
+ */
+static uint8_t package_ingest(FIL* file, char* path, uint32_t dir_len, char* buf, uint32_t size, uint32_t* addr, package_entry_t* entry) {
+    package_record_t* record      = NULL;
+    cJSON*            root        = NULL;
+    cJSON*            opt_check   = NULL;
+    const char*       file_name[2];
+    char              blob[2][PACKAGE_FILE_MAX];
+    uint32_t          record_addr = *addr;
+    uint32_t          flash_size[2];
+    uint32_t          check[3];
+    uint32_t          dev_id;
+    uint32_t          ram_size;
+    uint32_t          parallelism = 0;
+    uint32_t          reconnect   = 0;
+    uint8_t           result      = 0;
+    UINT              r_cnt       = 0;
+
+    /* 读取描述文件, 不超过缓冲区大小 */
+    if (f_open(file, path, FA_READ) != FR_OK) {
+        return 0;
+    }
+    if ((f_size(file) <= size) &&
+        (f_read(file, buf, size, &r_cnt) == FR_OK)) {
+        root = cJSON_ParseWithLength(buf, r_cnt);
+    }
+    f_close(file);
+    if (root == NULL) {
+        return 0;
+    }
+
+    /* 解析描述 */
+    if ((record = pvPortMalloc(sizeof(package_record_t))) == NULL) {
+        goto ex;
+    }
+    memset(record, 0, sizeof(package_record_t));
+    if ((cJSON_IsString(cJSON_GetObjectItem(root, "name")) == 0) ||
+        (package_json_u32(root, "devId", &dev_id) == 0) ||
+        (package_json_u32(root, "flashSizeAddr", &record->FlashSizeAddr) == 0) ||
+        (package_json_u32(root, "ramSize", &ram_size) == 0) ||
+        (package_json_array(cJSON_GetObjectItem(root, "flashSize"), flash_size, 2) == 0) ||
+        ((file_name[0] = package_parse_algo(cJSON_GetObjectItem(root, "flash"), &record->Algo[0])) == NULL) ||
+        ((file_name[1] = package_parse_algo(cJSON_GetObjectItem(root, "opt"), &record->Algo[1])) == NULL) ||
+        (strlen(file_name[0]) >= PACKAGE_FILE_MAX) ||
+        (strlen(file_name[1]) >= PACKAGE_FILE_MAX)) {
+        goto ex;
+    }
+    strcpy(blob[0], file_name[0]);
+    strcpy(blob[1], file_name[1]);
+    package_json_u32(root, "parallelism", &parallelism);
+    package_json_u32(root, "reconnectTime", &reconnect);
+    /* 选项字状态检查 [[寄存器地址, 掩码, 默认值], ...], 缺省时每次都复位选项字 */
+    opt_check = cJSON_GetObjectItem(root, "optCheck");
+    if (cJSON_GetArraySize(opt_check) > 2) {
+        goto ex;
+    }
+    for (uint8_t i = 0; i < cJSON_GetArraySize(opt_check); i++) {
+        if (package_json_array(cJSON_GetArrayItem(opt_check, i), check, 3) == 0) {
+            goto ex;
+        }
+        record->OptCheck[i].addr  = check[0];
+        record->OptCheck[i].mask  = check[1];
+        record->OptCheck[i].value = check[2];
+    }
+    strncpy(record->Name, cJSON_GetStringValue(cJSON_GetObjectItem(root, "name")), PACKAGE_NAME_SIZE - 1);
+    record->DevId         = dev_id & 0xFFF;
+    record->RamSize       = ram_size;
+    record->FlashSize[0]  = flash_size[0];
+    record->FlashSize[1]  = flash_size[1];
+    record->Parallelism   = parallelism;
+    record->ReconnectTime = reconnect;
+    cJSON_Delete(root);   // 复制算法代码前释放, 减少堆占用
+    root = NULL;
+
+    /* 复制算法代码, 记录写在代码之前 */
+    if (record_addr + PACKAGE_ALIGN(sizeof(package_record_t)) > SPI_FLASH_ALGO_ADDRESS + SPI_FLASH_ALGO_SIZE) {
+        goto ex;
+    }
+    *addr += PACKAGE_ALIGN(sizeof(package_record_t));
+    for (uint8_t i = 0; i < 2; i++) {
+        if (dir_len + strlen(blob[i]) >= PACKAGE_PATH_MAX) {
+            goto ex;
+        }
+        strcpy(path + dir_len, blob[i]);
+        record->Algo[i].algo_addr = *addr;
+        if ((record->Algo[i].algo_size = package_copy(file, path, addr, buf, size)) == 0) {
+            goto ex;
+        }
+    }
+    package_write(record, record_addr, sizeof(package_record_t));
+
+    entry->DevId        = record->DevId;
+    entry->FlashSize[0] = record->FlashSize[0];
+    entry->FlashSize[1] = record->FlashSize[1];
+    entry->Parallelism  = record->Parallelism;
+    entry->Reserved     = 0;
+    entry->Record       = record_addr;
+    result              = 1;
+
+ex:
+    if (record != NULL) {
+        vPortFree(record);
+    }
+    cJSON_Delete(root);
+    return result;
+}
+
+/**
+ * @brief  计算算法目录签名
+ * @note   目录内文件名、大小和修改时间任一变化时签名改变, 目录不存在时为0
+ * @param  path: 算法目录路径
+ * @param  info: 文件信息对象
+ * @retval 签名
+ */
+static uint32_t package_signature(const char* path, FILINFO* info) {
+    DIR      dir = {0};
+    uint32_t crc = 0;
+
+    if (f_opendir(&dir, path) != FR_OK) {
+        return 0;
+    }
+    while ((f_readdir(&dir, info) == FR_OK) && (*info->fname != '\0')) {
+        crc = CRC32_Update(crc, &info->fsize, sizeof(info->fsize));
+        crc = CRC32_Update(crc, &info->fdate, sizeof(info->fdate));
+        crc = CRC32_Update(crc, &info->ftime, sizeof(info->ftime));
+        crc = CRC32_Update(crc, info->fname, strlen(info->fname));
+    }
+    f_closedir(&dir);
+
+    return crc;
+}
+
+/**
+ * @brief  检查索引
+ * @param  signature: 算法目录签名
+ * @retval 1: 索引有效且与算法目录一致, 0: 需要重新导入
+ */
+static uint8_t package_index_valid(uint32_t signature) {
+    package_index_t index;
+    package_entry_t entry;
+    uint32_t        crc = 0;
+
+    SPI_FLASH_Read(&index, SPI_FLASH_ALGO_ADDRESS, sizeof(index));
+    if ((index.Magic != PACKAGE_INDEX_MAGIC) ||
+        (index.Signature != signature) ||
+        (index.Count > PACKAGE_MAX)) {
+        return 0;
+    }
+    for (uint32_t i = 0; i < index.Count; i++) {
+        package_read_entry(i, &entry);
+        crc = CRC32_Update(crc, &entry, sizeof(entry));
+    }
+    if (crc != index.Crc) {
+        return 0;
+    }
+    PackageCount = index.Count;
+
+    return 1;
+}
+
+/**
+ * @brief  导入算法包
+ * @note   算法目录未变化时沿用已有索引. 重新导入时先擦除索引, 全部算法包写入后最后写入索引,
+ *         中途掉电下次启动会重新导入
+ * @param  path: 算法目录路径
+ * @param  file: 文件对象
+ * @param  info: 文件信息对象
+ * @param  buf: 缓冲区
+ * @param  size: 缓冲区大小
+ * @retval None
+ */
+void FlashPackage_Load(const char* path, FIL* file, FILINFO* info, char* buf, uint32_t size) {
+    DIR              dir       = {0};
+    package_index_t  index     = {0};
+    package_entry_t* entries   = NULL;
+    char*            name      = NULL;
+    uint32_t         addr      = SPI_FLASH_ALGO_ADDRESS + W25QXX_BLOCK_SIZE;
+    uint32_t         signature = package_signature(path, info);
+    uint32_t         count     = 0;
+    uint32_t         len       = strlen(path);
+    char*            ext       = NULL;
+
+    PackageCount = 0;
+    if (package_index_valid(signature) != 0) {
+        return;
+    }
+    if (((entries = pvPortMalloc(sizeof(package_entry_t) * PACKAGE_MAX)) == NULL) ||
+        ((name = pvPortMalloc(PACKAGE_PATH_MAX)) == NULL) ||
+        (len + 1 >= PACKAGE_PATH_MAX)) {
+        goto ex;
+    }
+
+    /* 导入算法包 */
+    SPI_FLASH_Erase(SPI_FLASH_ALGO_ADDRESS);   // 先使旧索引失效
+    PackageErase = addr;
+    strcpy(name, path);
+    name[len++] = '/';
+    if (f_opendir(&dir, path) == FR_OK) {
+        while ((count < PACKAGE_MAX) &&
+               (f_readdir(&dir, info) == FR_OK) &&
+               (*info->fname != '\0')) {
+            ext = strrchr(info->fname, '.');
+            if (((info->fattrib & AM_DIR) != 0) ||
+                (ext == NULL) ||
+                ((strcmp(ext, ".json") != 0) && (strcmp(ext, ".JSON") != 0)) ||
+                (len + strlen(info->fname) >= PACKAGE_PATH_MAX)) {
+                continue;
+            }
+            strcpy(name + len, info->fname);
+            if (package_ingest(file, name, len, buf, size, &addr, &entries[count]) != 0) {
+                count++;
+            }
+        }
+        f_closedir(&dir);
+    }
+
+    /* 按DevId排序(插入排序, 相同DevId保持目录顺序) */
+    for (uint32_t i = 1; i < count; i++) {
+        package_entry_t key = entries[i];
+        uint32_t        j   = i;
+        for (; (j > 0) && (entries[j - 1].DevId > key.DevId); j--) {
+            entries[j] = entries[j - 1];
+        }
+        entries[j] = key;
+    }
+
+    /* 写入索引 */
+    index.Magic     = PACKAGE_INDEX_MAGIC;
+    index.Signature = signature;
+    index.Count     = count;
+    index.Crc       = CRC32_Update(0, entries, sizeof(package_entry_t) * count);
+    SPI_FLASH_Write(entries, SPI_FLASH_ALGO_ADDRESS + sizeof(index), sizeof(package_entry_t) * count);
+    SPI_FLASH_Write(&index, SPI_FLASH_ALGO_ADDRESS, sizeof(index));
+    PackageCount = count;
+
+ex:
+    if (entries != NULL) {
+        vPortFree(entries);
+    }
+    if (name != NULL) {
+        vPortFree(name);
+    }
+}
+
+/**
+ * @brief  打开算法包
+ * @note   算法代码不读入内存, 下载时直接从SPI Flash读取
+ * @param  entry: 索引项
+ * @retval 指向FlashBlobList_t的指针, 失败时返回NULL
+ */
+static FlashBlobList_t* package_open(const package_entry_t* entry) {
+    package_record_t* record = NULL;
+
+    if ((record = pvPortMalloc(sizeof(package_record_t))) == NULL) {
+        return NULL;
+    }
+    SPI_FLASH_Read(record, entry->Record, sizeof(package_record_t));
+
+    for (uint8_t i = 0; i < 2; i++) {
+        const package_algo_t*  algo   = &record->Algo[i];
+        const program_target_t target = {
+            .init                = algo->entry[0],
+            .uninit              = algo->entry[1],
+            .erase_chip          = algo->entry[2],
+            .erase_sector        = algo->entry[3],
+            .program_page        = algo->entry[4],
+            .set_rdp             = algo->entry[5],
+            .verify              = algo->entry[6],
+            .sys_call_s          = algo->sys_call_s,
+            .program_buffer      = algo->program_buffer,
+            .program_buffer2     = algo->program_buffer2,
+            .algo_start          = algo->algo_start,
+            .algo_size           = algo->algo_size,
+            .algo_blob           = NULL,
+            .program_buffer_size = algo->program_buffer_size,
+            .sector_info         = PackageSector[i],
+            .sector_info_count   = algo->sector_info_count,
+            .timing              = algo->timing,
+            .algo_addr           = algo->algo_addr,
+        };
+        memcpy(PackageSector[i], algo->sector_info, sizeof(PackageSector[i]));
+        memcpy(&PackageTarget[i], &target, sizeof(program_target_t));
+    }
+
+    memcpy(PackageName, record->Name, PACKAGE_NAME_SIZE);
+    PackageName[PACKAGE_NAME_SIZE - 1] = '\0';
+
+    const FlashBlobList_t blob = {
+        .DevId         = record->DevId,
+        .Name          = PackageName,
+        .FlashSizeAddr = record->FlashSizeAddr,
+        .FlashSize     = {record->FlashSize[0], record->FlashSize[1]},
+        .RamSize       = record->RamSize,
+        .Parallelism   = record->Parallelism,
+        .ReconnectTime = record->ReconnectTime,
+        .OptCheck      = {record->OptCheck[0], record->OptCheck[1]},
+        .prog_flash    = &PackageTarget[0],
+        .prog_opt      = &PackageTarget[1],
+    };
+    memcpy(&PackageBlob, &blob, sizeof(FlashBlobList_t));
+    vPortFree(record);
+
+    return &PackageBlob;
+}
+
+/**
+ * @brief  根据设备ID和Flash大小查找算法包
+ * @note   在索引中二分查找第一个DevId匹配的索引项, 再依次比较Flash大小和编程并行位数.
+ *         返回的算法信息保存在静态区, 下一次查找时覆盖
+ * @param  id: 设备ID
+ * @param  flash_size: Flash大小, 为0时不区分
+ * @param  parallelism: 编程并行位数(8/16/32/64), 为0时不区分
+ * @retval 指向FlashBlobList_t的指针，如果未找到则返回NULL
+ */
+FlashBlobList_t* FlashPackage_Get(uint16_t id, uint16_t flash_size, uint8_t parallelism) {
+    package_entry_t entry;
+    uint32_t        low  = 0;
+    uint32_t        high = PackageCount;
+    uint32_t        mid;
+
+    while (low < high) {
+        mid = (low + high) / 2;
+        package_read_entry(mid, &entry);
+        if (entry.DevId < id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    for (; low < PackageCount; low++) {
+        package_read_entry(low, &entry);
+        if (entry.DevId != id) {
+            break;
+        }
+        if (((flash_size == 0) ||
+             ((flash_size >= entry.FlashSize[0]) &&
+              (flash_size <= entry.FlashSize[1]))) &&
+            ((parallelism == 0) ||
+             (entry.Parallelism == 0) ||
+             (entry.Parallelism == parallelism))) {
+            return package_open(&entry);
+        }
+    }
+    return NULL;   // 未找到对应的算法包
+}
+
+/**
+ * @brief  检查设备名称是否已在列表中
+ * @note   按整行比较, 避免名称互为前缀时误判
+ * @param  str: 列表字符串
+ * @param  name: 设备名称
+ * @retval 1: 已存在, 0: 不存在
+ */
+static uint8_t package_listed(const char* str, const char* name) {
+    size_t len = strlen(name);
+
+    for (const char* p = str; (p = strstr(p, name)) != NULL; p++) {
+        if (((p == str) || (p[-1] == '\n')) && (p[len] == '\r')) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief  追加算法包设备名称到列表字符串
+ * @param  str: 字符串缓冲区
+ * @param  size: 缓冲区大小
+ * @retval None
+ */
+void FlashPackage_ListStr(char* str, uint32_t size) {
+    package_entry_t entry;
+    char            name[PACKAGE_NAME_SIZE];
+
+    for (uint32_t i = 0; i < PackageCount; i++) {
+        package_read_entry(i, &entry);
+        SPI_FLASH_Read(name, entry.Record, sizeof(name));   // 设备名称位于记录开头
+        name[PACKAGE_NAME_SIZE - 1] = '\0';
+        if (package_listed(str, name) != 0) {
+            /* 如果设备名称已存在，则跳过 */
+            continue;
+        }
+        if (strlen(str) + strlen(name) + 2 >= size) {
+            break;
+        }
+        strcat(str, name);     // 添加设备名称
+        strcat(str, "\r\n");   // 添加换行符
+    }
+}
@@ -0,0 +1,11 @@
+#ifndef __FLASH_PACKAGE_H__
+#define __FLASH_PACKAGE_H__
+
+#include "ff.h"
+#include "flash_blob.h"
+
+void             FlashPackage_Load(const char* path, FIL* file, FILINFO* info, char* buf, uint32_t size);
+FlashBlobList_t* FlashPackage_Get(uint16_t id, uint16_t flash_size, uint8_t parallelism);
+void             FlashPackage_ListStr(char* str, uint32_t size);
+
+#endif
@@ -1,16 +1,42 @@
 #include "SPI_Flash.h"
+#include "FlashLayout.h"
 #include "stdio.h"
 
+#define SFDP_SIGNATURE 0x50444653   // "SFDP"
+#define SFDP_ID_BFPT   0xFF00       // 基本参数表
+#define SFDP_ID_4BAIT  0xFF84       // 4字节地址指令表
+
+#define W25QXX_RESUME_TIME  2   // 恢复擦除后至少经过的时间(ms), 之后才允许再次暂停, 保证擦除有进展
+#define W25QXX_SUSPEND_TIME 2   // 等待暂停生效的最长时间(ms)
+
 struct SPI_Flash_Struct {
-    uint32_t Capacity;   // Flash容量
+    uint32_t Capacity;         // Flash容量
+    uint32_t ProgramSize;      // 程序区大小
+    uint8_t  AddrBytes;        // 地址字节数(3/4)
+    uint8_t  ReadCmd;          // 读取命令
+    uint8_t  ReadDummy;        // 读取命令后的空字节数
+    uint8_t  ProgramCmd;       // 页编程命令
+    uint8_t  EraseCmd[3];      // 4K/32K/64K擦除命令, 为0时不支持
+    uint8_t  SuspendCmd;       // 擦除暂停命令, 为0时不支持
+    uint8_t  ResumeCmd;        // 擦除恢复命令
+    uint8_t  Suspended;        // 擦除已暂停
+    uint32_t EraseAddr;        // 后台擦除的区间起始地址
+    uint32_t EraseEnd;         // 后台擦除的区间结束地址, 与起始地址相等时没有擦除
+    uint32_t ResumeTick;       // 擦除开始或恢复的时间
+    uint32_t (*Tick)(void);    // 毫秒时基, 为NULL时不暂停擦除
 } SPI_Flash;
 
+static const uint8_t W25QXX_EraseShift[3] = {12, 15, 16};   // 各擦除粒度的大小(2的幂)
+
+static void W25QXX_Probe(void);
+
 /**
  * @brief  初始化W25Qxx
- * @note
+ * @note   没有时基时(如引导程序)不使用擦除暂停, 读取前等待擦除结束
+ * @param  tick: 毫秒时基, 可为NULL
  * @retval None
  */
-void W25QXX_Init(void) {
+void W25QXX_Init(uint32_t (*tick)(void)) {
     GPIO_InitTypeDef GPIO_InitStructure;
     /* 使能时钟 */
     RCC_APB2PeriphClockCmd(W25QXX_CS_RCCCLOCK, ENABLE);
@@ -23,8 +49,16 @@ void W25QXX_Init(void) {
     GPIO_SetBits(W25QXX_CS_PORT, W25QXX_CS_PIN);
     /* 初始化SPI */
     W25QXX_SPI_Init();
-    /* 获取芯片容量 */
-    SPI_Flash.Capacity = W25QXX_ReadCapacity();
+    /* 识别芯片容量和指令 */
+    SPI_Flash.Tick = tick;
+    W25QXX_Probe();
+    /* 按容量比例计算程序区大小(容量的3/16) */
+    SPI_Flash.ProgramSize = SPI_Flash.Capacity / 16 * 3;
+    if (SPI_Flash.ProgramSize < SPI_FLASH_PROGRAM_SIZE_MIN) {
+        SPI_Flash.ProgramSize = SPI_FLASH_PROGRAM_SIZE_MIN;
+    } else if (SPI_Flash.ProgramSize > SPI_FLASH_PROGRAM_SIZE_MAX) {
+        SPI_Flash.ProgramSize = SPI_FLASH_PROGRAM_SIZE_MAX;
+    }
 }
 
 /**
@@ -81,6 +115,8 @@ void W25QXX_Write_Disable(void) {
  */
 uint16_t W25QXX_ReadID(void) {
     uint16_t id = 0;
+    /* 等待擦除结束 */
+    W25QXX_WaitBusy();
     /* 片选器件 */
     W25QXX_CS_0;
     /* 发送读取ID命令 */
@@ -100,28 +136,264 @@ uint16_t W25QXX_ReadID(void) {
 
 /**
  * @brief  读取芯片容量
- * @note
+ * @note   初始化时识别
  * @retval 芯片容量(字节)
  */
 uint32_t W25QXX_ReadCapacity(void) {
-    uint16_t id;
-    uint32_t capacity = 1;
-    /* 读取芯片制造ID */
-    id = W25QXX_ReadID();
-    if (id == 0xFFFF) {
+    return SPI_Flash.Capacity;
+}
+
+/**
+ * @brief  读取程序区大小
+ * @note   初始化时按容量计算
+ * @retval 程序区大小(字节)
+ */
+uint32_t W25QXX_ReadProgramSize(void) {
+    return SPI_Flash.ProgramSize;
+}
+
+/**
+ * @brief  DMA传输完成回调
+ * @note   取消片选, 读取前暂停了擦除时恢复擦除
+ * @retval None
+ */
+static void W25QXX_Release(void) {
+    W25QXX_CS_1;
+    if (SPI_Flash.Suspended != 0) {
+        W25QXX_CS_0;
+        W25QXX_ReadWriteByte(SPI_Flash.ResumeCmd);
+        W25QXX_CS_1;
+        SPI_Flash.Suspended  = 0;
+        SPI_Flash.ResumeTick = SPI_Flash.Tick();
+    }
+}
+
+/**
+ * @brief  读取前处理后台擦除
+ * @note   擦除进行中且读取区间不在擦除区间内时暂停擦除, 读取完成后由W25QXX_Release恢复;
+ *         距上次恢复不足W25QXX_RESUME_TIME时等到该时刻再暂停;
+ *         不支持暂停、读取擦除中的区间或暂停未生效时等待擦除结束
+ * @param  r_addr: 读取地址
+ * @param  count: 读取字节数
+ * @retval None
+ */
+static void W25QXX_Schedule(uint32_t r_addr, uint32_t count) {
+    uint32_t tick;
+
+    if ((SPI_Flash.EraseEnd != SPI_Flash.EraseAddr) &&
+        (SPI_Flash.SuspendCmd != 0) &&
+        ((r_addr >= SPI_Flash.EraseEnd) || (r_addr + count <= SPI_Flash.EraseAddr))) {
+        /* 保证擦除有进展 */
+        while ((SPI_Flash.Tick() - SPI_Flash.ResumeTick < W25QXX_RESUME_TIME) &&
+               ((W25QXX_ReadSR() & 0x01) == 0x01)) {
+        }
+        if ((W25QXX_ReadSR() & 0x01) == 0) {
+            SPI_Flash.EraseEnd = SPI_Flash.EraseAddr;   // 擦除已结束
+            return;
+        }
+        W25QXX_CS_0;
+        W25QXX_ReadWriteByte(SPI_Flash.SuspendCmd);
+        W25QXX_CS_1;
+        SPI_Flash.Suspended = 1;
+        /* 暂停生效后忙位清除 */
+        tick = SPI_Flash.Tick();
+        while ((W25QXX_ReadSR() & 0x01) == 0x01) {
+            if (SPI_Flash.Tick() - tick > W25QXX_SUSPEND_TIME) {
+                SPI_Flash.Suspended = 0;   // 暂停未生效
+                break;
+            }
+        }
+        if (SPI_Flash.Suspended != 0) {
+            return;
+        }
+    }
+    W25QXX_WaitBusy();
+}
+
+/**
+ * @brief  读取SFDP参数
+ * @note   3字节地址, 命令后8个空时钟
+ * @param  addr: 参数地址
+ * @param  buf: 读取缓冲区
+ * @param  count: 读取字节数
+ * @retval None
+ */
+static void W25QXX_ReadSFDP(uint32_t addr, void* buf, uint32_t count) {
+    /* 等待写入结束 */
+    W25QXX_WaitBusy();
+    /* 片选器件 */
+    W25QXX_CS_0;
+    /* 发送读取SFDP命令和地址 */
+    W25QXX_ReadWriteByte(W25QX_ReadSFDP);
+    W25QXX_ReadWriteByte((uint8_t) (addr >> 16));
+    W25QXX_ReadWriteByte((uint8_t) (addr >> 8));
+    W25QXX_ReadWriteByte((uint8_t) (addr));
+    W25QXX_ReadWriteByte(0xFF);
+    /* 读取数据, 完成时取消片选 */
+    W25QXX_DmaTransfer(NULL, buf, count, W25QXX_Release);
+    W25QXX_DmaWait();
+}
+
+/**
+ * @brief  解析SFDP参数表
+ * @note   基本参数表给出容量和各擦除类型, 4字节地址指令表给出4字节地址下可用的指令;
+ *         只有单线SPI, 读取使用1-1-1快速读
+ * @param  erase: 返回基本参数表中各擦除类型对应的擦除粒度序号, 0xFF为不使用
+ * @param  ext: 返回4字节地址指令表[0]: 支持的指令, [1]: 各擦除类型的指令, 不存在时为0
+ * @retval 1: 成功, 0: 器件不支持SFDP
+ */
+static uint8_t W25QXX_ParseSFDP(uint8_t erase[4], uint32_t ext[2]) {
+    uint32_t header[2];         // SFDP头
+    uint32_t param[2];          // 参数头
+    uint32_t table[13] = {0};   // 基本参数表
+    uint8_t  found     = 0;
+
+    W25QXX_ReadSFDP(0, header, sizeof(header));
+    if (header[0] != SFDP_SIGNATURE) {
+        return 0;
+    }
+    ext[0] = 0;
+    ext[1] = 0;
+    for (uint32_t i = 0; i <= ((header[1] >> 16) & 0xFF); i++) {
+        W25QXX_ReadSFDP(8 + i * 8, param, sizeof(param));
+        uint16_t id  = ((param[1] >> 16) & 0xFF00) | (param[0] & 0xFF);
+        uint32_t len = (param[0] >> 24) * 4;
+        if ((id == SFDP_ID_BFPT) && (found == 0)) {
+            W25QXX_ReadSFDP(param[1] & 0xFFFFFF, table, (len < sizeof(table)) ? len : sizeof(table));
+            found = 1;
+        } else if ((id == SFDP_ID_4BAIT) && (len >= sizeof(ext[0]) * 2)) {
+            W25QXX_ReadSFDP(param[1] & 0xFFFFFF, ext, sizeof(ext[0]) * 2);
+        }
+    }
+    if (found == 0) {
         return 0;
     }
-    /* 获取容量信息(BCD码) */
-    id &= 0x00FF;
-    /* 转换次幂 */
-    id = ((id >> 4) * 10) + (id & 0x0F);
-    /* 计算容量 */
-    for (; id; id--) {
-        capacity *= 2;
+    /* 容量: 最高位为1时为2^N位, 否则为N+1位 */
+    if ((table[1] & 0x80000000) == 0) {
+        SPI_Flash.Capacity = (table[1] + 1) / 8;
+    } else if ((table[1] & 0x7FFFFFFF) < 35) {
+        SPI_Flash.Capacity = 1UL << ((table[1] & 0x7FFFFFFF) - 3);
+    } else {
+        return 0;
+    }
+    /* 擦除类型1~4: [大小(2的幂), 指令] */
+    for (uint8_t i = 0; i < 4; i++) {
+        uint8_t shift = (uint8_t) (table[7 + i / 2] >> (i % 2 * 16));
+        uint8_t cmd   = (uint8_t) (table[7 + i / 2] >> (i % 2 * 16 + 8));
+        erase[i]      = 0xFF;
+        for (uint8_t j = 0; j < sizeof(W25QXX_EraseShift); j++) {
+            if ((shift == W25QXX_EraseShift[j]) && (cmd != 0xFF)) {
+                SPI_Flash.EraseCmd[j] = cmd;
+                erase[i]              = j;
+            }
+        }
+    }
+    /* 旧版参数表没有擦除类型时按第1个双字的4K擦除指令 */
+    if (((table[0] & 0x03) == 0x01) && (SPI_Flash.EraseCmd[0] == 0)) {
+        SPI_Flash.EraseCmd[0] = (uint8_t) (table[0] >> 8);
     }
-    capacity *= 1024 / 8;
-    /* 返回容量 */
-    return capacity;
+    /* 第12个双字最高位为0时支持暂停/恢复, 第13个双字给出擦除暂停和恢复命令 */
+    if ((table[12] != 0) && ((table[11] & 0x80000000) == 0)) {
+        SPI_Flash.SuspendCmd = (uint8_t) (table[12] >> 24);
+        SPI_Flash.ResumeCmd  = (uint8_t) (table[12] >> 16);
+    }
+    SPI_Flash.ReadCmd   = W25QX_FastReadData;
+    SPI_Flash.ReadDummy = 1;
+    return 1;
+}
+
+/**
+ * @brief  识别芯片容量和指令
+ * @note   优先按SFDP参数表, 不支持时按JEDEC ID的容量字节, 再按旧的制造ID推算;
+ *         超过16M时使用4字节地址指令
+ * @retval None
+ */
+static void W25QXX_Probe(void) {
+    uint8_t  jedec[3];
+    uint8_t  erase[4] = {0xFF, 0xFF, 0xFF, 0xFF};   // 各擦除类型对应的擦除粒度序号
+    uint32_t ext[2]   = {0};                        // 4字节地址指令表
+
+    SPI_Flash.Capacity    = 0;
+    SPI_Flash.AddrBytes   = 3;
+    SPI_Flash.ReadCmd     = W25QX_ReadData;
+    SPI_Flash.ReadDummy   = 0;
+    SPI_Flash.ProgramCmd  = W25QX_PageProgram;
+    SPI_Flash.EraseCmd[0] = 0;
+    SPI_Flash.EraseCmd[1] = 0;
+    SPI_Flash.EraseCmd[2] = 0;
+    SPI_Flash.SuspendCmd  = 0;
+    SPI_Flash.ResumeCmd   = 0;
+    SPI_Flash.EraseEnd    = SPI_Flash.EraseAddr;
+
+    /* 读取JEDEC ID */
+    W25QXX_CS_0;
+    W25QXX_ReadWriteByte(W25QX_JedecDeviceID);
+    for (uint8_t i = 0; i < sizeof(jedec); i++) {
+        jedec[i] = W25QXX_ReadWriteByte(0xFF);
+    }
+    W25QXX_CS_1;
+    /* Winbond和GigaDevice的器件都支持0x75/0x7A暂停/恢复擦除, 暂停需要时基 */
+    if ((SPI_Flash.Tick != NULL) && ((jedec[0] == 0xEF) || (jedec[0] == 0xC8))) {
+        SPI_Flash.SuspendCmd = W25QX_EraseSuspend;
+        SPI_Flash.ResumeCmd  = W25QX_EraseResume;
+    }
+
+    if (W25QXX_ParseSFDP(erase, ext) == 0) {
+        /* 容量字节为2的幂 */
+        if ((jedec[0] != 0x00) && (jedec[0] != 0xFF) &&
+            (jedec[2] >= 0x10) && (jedec[2] < 0x20)) {
+            SPI_Flash.Capacity = 1UL << jedec[2];
+        } else {
+            /* 按制造ID的容量信息(BCD码)推算 */
+            uint16_t id = W25QXX_ReadID();
+            if (id == 0xFFFF) {
+                return;
+            }
+            id                 = (((id & 0xFF) >> 4) * 10) + (id & 0x0F);
+            SPI_Flash.Capacity = (1UL << id) * 1024 / 8;
+        }
+        SPI_Flash.EraseCmd[0] = W25QX_SectorErase;
+        SPI_Flash.EraseCmd[2] = W25QX_BlockErase;
+    }
+    if (SPI_Flash.EraseCmd[0] == 0) {
+        SPI_Flash.EraseCmd[0] = W25QX_SectorErase;
+    }
+
+    /* 超过16M使用4字节地址指令 */
+    if (SPI_Flash.Capacity > 0x01000000) {
+        static const uint8_t cmd4b[3] = {W25QX_SectorErase4B, W25QX_BlockErase32K4B, W25QX_BlockErase4B};
+        SPI_Flash.AddrBytes           = 4;
+        SPI_Flash.ReadCmd             = (SPI_Flash.ReadDummy != 0) ? W25QX_FastReadData4B : W25QX_ReadData4B;
+        SPI_Flash.ProgramCmd          = W25QX_PageProgram4B;
+        for (uint8_t j = 0; j < sizeof(cmd4b); j++) {
+            SPI_Flash.EraseCmd[j] = (SPI_Flash.EraseCmd[j] != 0) ? cmd4b[j] : 0;
+        }
+        /* 有4字节地址指令表时按表中的擦除指令 */
+        if (ext[0] != 0) {
+            for (uint8_t i = 0; i < 4; i++) {
+                if ((erase[i] != 0xFF) && (ext[0] & (1UL << (9 + i)))) {
+                    SPI_Flash.EraseCmd[erase[i]] = (uint8_t) (ext[1] >> (i * 8));
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief  发送命令和地址
+ * @note   须先片选器件, 地址字节数由识别结果决定
+ * @param  cmd: 命令
+ * @param  addr: 地址
+ * @retval None
+ */
+static void W25QXX_Command(uint8_t cmd, uint32_t addr) {
+    W25QXX_ReadWriteByte(cmd);
+    if (SPI_Flash.AddrBytes == 4) {
+        W25QXX_ReadWriteByte((uint8_t) (addr >> 24));
+    }
+    W25QXX_ReadWriteByte((uint8_t) (addr >> 16));
+    W25QXX_ReadWriteByte((uint8_t) (addr >> 8));
+    W25QXX_ReadWriteByte((uint8_t) (addr));
 }
 
 /**
@@ -132,24 +404,41 @@ uint32_t W25QXX_ReadCapacity(void) {
  * @param  count: 读取字节数
  * @retval None
  */
-void W25QXX_Read(void* r_bf, uint32_t r_addr, uint16_t count) {
-    uint8_t* r_poi = r_bf;
-    /* 等待写入结束 */
-    W25QXX_WaitBusy();
+void W25QXX_Read(void* r_bf, uint32_t r_addr, uint32_t count) {
+    W25QXX_ReadStart(r_bf, r_addr, count);
+    W25QXX_ReadWait();
+}
+
+/**
+ * @brief  启动DMA读取数据
+ * @note   发送命令和地址后由DMA接收数据, 立即返回, 接收完成时取消片选;
+ *         须调用W25QXX_ReadWait结束后才能进行其他操作
+ * @param  r_bf: 读取缓冲区
+ * @param  r_addr: 读取地址
+ * @param  count: 读取字节数
+ * @retval None
+ */
+void W25QXX_ReadStart(void* r_bf, uint32_t r_addr, uint32_t count) {
+    /* 等待写入结束, 或暂停后台擦除 */
+    W25QXX_Schedule(r_addr, count);
     /* 片选器件 */
     W25QXX_CS_0;
-    /* 发送读取数据命令 */
-    W25QXX_ReadWriteByte(W25QX_ReadData);
-    /* 发送数据地址 */
-    W25QXX_ReadWriteByte((uint8_t) (r_addr >> 16));
-    W25QXX_ReadWriteByte((uint8_t) (r_addr >> 8));
-    W25QXX_ReadWriteByte((uint8_t) (r_addr));
-    /* 循环读取数据 */
-    while (count--) {
-        *r_poi++ = W25QXX_ReadWriteByte(0XFF);
+    /* 发送读取数据命令和地址, 快速读取需要空字节 */
+    W25QXX_Command(SPI_Flash.ReadCmd, r_addr);
+    for (uint8_t i = 0; i < SPI_Flash.ReadDummy; i++) {
+        W25QXX_ReadWriteByte(0xFF);
     }
-    /* 取消片选 */
-    W25QXX_CS_1;
+    /* 启动DMA接收 */
+    W25QXX_DmaTransfer(NULL, r_bf, count, W25QXX_Release);
+}
+
+/**
+ * @brief  等待DMA读取结束
+ * @note
+ * @retval None
+ */
+void W25QXX_ReadWait(void) {
+    W25QXX_DmaWait();
 }
 
 /**
@@ -161,25 +450,17 @@ void W25QXX_Read(void* r_bf, uint32_t r_addr, uint16_t count) {
  * @retval None
  */
 void W25QXX_WritePage(void* w_bf, uint32_t w_addr, uint16_t count) {
-    uint8_t* w_poi = w_bf;
     /* 等待写入结束 */
     W25QXX_WaitBusy();
     /* 写使能 */
     W25QXX_Write_Enable();
     /* 片选器件 */
     W25QXX_CS_0;
-    /* 发送页编程命令 */
-    W25QXX_ReadWriteByte(W25QX_PageProgram);
-    /* 发送数据地址 */
-    W25QXX_ReadWriteByte((uint8_t) (w_addr >> 16));
-    W25QXX_ReadWriteByte((uint8_t) (w_addr >> 8));
-    W25QXX_ReadWriteByte((uint8_t) (w_addr));
-    /* 循环写入 */
-    while (count--) {
-        W25QXX_ReadWriteByte(*w_poi++);
-    }
-    /* 取消片选 */
-    W25QXX_CS_1;
+    /* 发送页编程命令和地址 */
+    W25QXX_Command(SPI_Flash.ProgramCmd, w_addr);
+    /* DMA发送数据, 完成时取消片选 */
+    W25QXX_DmaTransfer(w_bf, NULL, count, W25QXX_Release);
+    W25QXX_DmaWait();
     /* 等待写入结束 */
     W25QXX_WaitBusy();
 }
@@ -192,31 +473,22 @@ void W25QXX_WritePage(void* w_bf, uint32_t w_addr, uint16_t count) {
  * @param  count: 写入字节数
  * @retval None
  */
-void W25QXX_Write(void* w_bf, uint32_t w_addr, uint16_t count) {
+void W25QXX_Write(void* w_bf, uint32_t w_addr, uint32_t count) {
     uint8_t* w_poi = w_bf;
     uint16_t page_byte;
     /* 写入 */
     while (count) {
         /* 计算当前页剩余空间 */
         page_byte = 256 - w_addr % 256;
-        /* 如果剩余写入字节大于当前页剩余空间 */
-        if (count > page_byte) {
-            /* 写完剩余页 */
-            W25QXX_WritePage(w_poi, w_addr, page_byte);
-            /* 计算参量 */
-            w_poi += page_byte;
-            w_addr += page_byte;
-            count -= page_byte;
-        }
-        /* 如果剩余写入字节小于当前页剩余空间 */
-        else if (count <= page_byte) {
-            /* 写完剩余数据 */
-            W25QXX_WritePage(w_poi, w_addr, count);
-            /* 计算参量 */
-            w_poi += count;
-            w_addr += count;
-            count -= count;
+        /* 剩余写入字节小于当前页剩余空间时写完剩余数据 */
+        if (count < page_byte) {
+            page_byte = count;
         }
+        W25QXX_WritePage(w_poi, w_addr, page_byte);
+        /* 计算参量 */
+        w_poi += page_byte;
+        w_addr += page_byte;
+        count -= page_byte;
     }
 }
 
@@ -228,9 +500,9 @@ void W25QXX_Write(void* w_bf, uint32_t w_addr, uint16_t count) {
  * @param  count: 写入字节数
  * @retval None
  */
-void W25QXX_WriteAutoErase(void* w_bf, uint32_t w_addr, uint16_t count) {
+void W25QXX_WriteAutoErase(void* w_bf, uint32_t w_addr, uint32_t count) {
     uint32_t sector_addr = 0;
-    uint16_t w_cnt       = 0;
+    uint32_t w_cnt       = 0;
     while (count != 0) {
         sector_addr = w_addr & 0xFFFFF000;   // 扇区地址
         if (w_addr == sector_addr) {
@@ -264,16 +536,53 @@ void W25QXX_EraseSector(uint32_t address) {
     W25QXX_Write_Enable();
     /* 片选器件 */
     W25QXX_CS_0;
-    /* 发送擦除扇区指令 */
-    W25QXX_ReadWriteByte(W25QX_SectorErase);
-    /* 发送擦除地址 */
-    W25QXX_ReadWriteByte((uint8_t) (address >> 16));
-    W25QXX_ReadWriteByte((uint8_t) (address >> 8));
-    W25QXX_ReadWriteByte((uint8_t) (address));
+    /* 发送擦除扇区指令和地址 */
+    W25QXX_Command(SPI_Flash.EraseCmd[0], address);
     /* 取消片选 */
     W25QXX_CS_1;
-    /* 等待写入结束 */
-    W25QXX_WaitBusy();
+    /* 后台擦除 */
+    SPI_Flash.EraseAddr  = address;
+    SPI_Flash.EraseEnd   = address + 4096;
+    SPI_Flash.ResumeTick = (SPI_Flash.Tick != NULL) ? SPI_Flash.Tick() : 0;
+}
+
+/**
+ * @brief  擦除区间 自动选择擦除粒度
+ * @note   按4K对齐, 地址对齐且剩余足够时使用器件支持的最大擦除粒度
+ * @param  address: 起始地址
+ * @param  size: 擦除字节数
+ * @retval None
+ */
+void W25QXX_EraseRange(uint32_t address, uint32_t size) {
+    uint32_t end = (address + size + 4095) / 4096 * 4096;
+    uint8_t  i;
+
+    address = address / 4096 * 4096;
+    while (address < end) {
+        for (i = sizeof(W25QXX_EraseShift) - 1; i > 0; i--) {
+            uint32_t block = 1UL << W25QXX_EraseShift[i];
+            if ((SPI_Flash.EraseCmd[i] != 0) &&
+                ((address & (block - 1)) == 0) &&
+                (end - address >= block)) {
+                break;
+            }
+        }
+        /* 等待忙位 */
+        W25QXX_WaitBusy();
+        /* 写使能 */
+        W25QXX_Write_Enable();
+        /* 片选器件 */
+        W25QXX_CS_0;
+        /* 发送擦除指令和地址 */
+        W25QXX_Command(SPI_Flash.EraseCmd[i], address);
+        /* 取消片选 */
+        W25QXX_CS_1;
+        /* 后台擦除 */
+        SPI_Flash.EraseAddr  = address;
+        SPI_Flash.EraseEnd   = address + (1UL << W25QXX_EraseShift[i]);
+        SPI_Flash.ResumeTick = (SPI_Flash.Tick != NULL) ? SPI_Flash.Tick() : 0;
+        address              = SPI_Flash.EraseEnd;
+    }
 }
 
 /**
@@ -284,6 +593,7 @@ void W25QXX_EraseSector(uint32_t address) {
 void W25QXX_WaitBusy(void) {
     while ((W25QXX_ReadSR() & 0x01) == 0x01) {
     }
+    SPI_Flash.EraseEnd = SPI_Flash.EraseAddr;
 }
 
 /**
@@ -292,6 +602,8 @@ void W25QXX_WaitBusy(void) {
  * @retval None
  */
 void W25QXX_PowerDown(void) {
+    /* 等待擦除结束 */
+    W25QXX_WaitBusy();
     /* 片选器件 */
     W25QXX_CS_0;
     /* 发送掉电命令 */
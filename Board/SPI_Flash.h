@@ -20,6 +20,18 @@
 #define W25QX_DeviceID         0xAB
 #define W25QX_ManufactDeviceID 0x90
 #define W25QX_JedecDeviceID    0x9F
+#define W25QX_ReadSFDP         0x5A
+#define W25QX_BlockErase32K    0x52
+#define W25QX_EraseSuspend     0x75
+#define W25QX_EraseResume      0x7A
+
+// 4字节地址指令, 不切换器件的地址模式, 3字节地址的引导程序不受影响
+#define W25QX_ReadData4B       0x13
+#define W25QX_FastReadData4B   0x0C
+#define W25QX_PageProgram4B    0x12
+#define W25QX_SectorErase4B    0x21
+#define W25QX_BlockErase32K4B  0x5C
+#define W25QX_BlockErase4B     0xDC
 
 #define W25QXX_BLOCK_SIZE (0x1000)   // 4K
 
@@ -44,9 +56,11 @@
         SPI1_Init();      \
     }
 
-#define W25QXX_ReadWriteByte(data) SPI1_ReadWriteByte(data)
-#define W25QXX_Bus_Take()          SPI1_Take()
-#define W25QXX_Bus_Give()          SPI1_Give()
+#define W25QXX_ReadWriteByte(data)                  SPI1_ReadWriteByte(data)
+#define W25QXX_DmaTransfer(tx, rx, count, callback) SPI1_DmaTransfer(tx, rx, count, callback)
+#define W25QXX_DmaWait()                            SPI1_DmaWait()
+#define W25QXX_Bus_Take()                           SPI1_Take()
+#define W25QXX_Bus_Give()                           SPI1_Give()
 
 typedef enum {
 
@@ -61,22 +75,28 @@ typedef enum {
 
 } SPI_FlashWorkState;
 
-#define SPI_FLASH_Init()                     W25QXX_Init()                       // 初始化
-#define SPI_FLASH_Write(w_bf, w_addr, count) W25QXX_Write(w_bf, w_addr, count)   // 写入数据
-#define SPI_FLASH_Read(r_bf, r_addr, count)  W25QXX_Read(r_bf, r_addr, count)    // 读取数据
-#define SPI_FLASH_Erase(address)             W25QXX_EraseSector(address)         // 擦除扇区
+#define SPI_FLASH_Init(tick)                     W25QXX_Init(tick)                       // 初始化
+#define SPI_FLASH_Write(w_bf, w_addr, count)     W25QXX_Write(w_bf, w_addr, count)       // 写入数据
+#define SPI_FLASH_Read(r_bf, r_addr, count)      W25QXX_Read(r_bf, r_addr, count)        // 读取数据
+#define SPI_FLASH_ReadStart(r_bf, r_addr, count) W25QXX_ReadStart(r_bf, r_addr, count)   // 启动后台读取
+#define SPI_FLASH_ReadWait()                     W25QXX_ReadWait()                       // 等待后台读取完成
+#define SPI_FLASH_Erase(address)                 W25QXX_EraseSector(address)             // 擦除扇区
 
-void     W25QXX_Init(void);                                                    // 初始化W25Qxx
+void     W25QXX_Init(uint32_t (*tick)(void));                                  // 初始化W25Qxx
 uint8_t  W25QXX_ReadSR(void);                                                  // 读SR寄存器
 void     W25QXX_Write_Enable(void);                                            // W25Qxx 写使能
 void     W25QXX_Write_Disable(void);                                           // W25Qxx 写禁止
 uint16_t W25QXX_ReadID(void);                                                  // W25Qxx 读取芯片ID
 uint32_t W25QXX_ReadCapacity(void);                                            // 读取芯片容量
-void     W25QXX_Read(void* r_bf, uint32_t r_addr, uint16_t count);             // 直接读取数据
+uint32_t W25QXX_ReadProgramSize(void);                                         // 读取程序区大小
+void     W25QXX_Read(void* r_bf, uint32_t r_addr, uint32_t count);             // 直接读取数据
+void     W25QXX_ReadStart(void* r_bf, uint32_t r_addr, uint32_t count);        // 启动DMA读取数据
+void     W25QXX_ReadWait(void);                                                // 等待DMA读取结束
 void     W25QXX_WritePage(void* w_bf, uint32_t w_addr, uint16_t count);        // 写页 最大256字节
-void     W25QXX_Write(void* w_bf, uint32_t w_addr, uint16_t count);            // 直接写入数据 自动换页 无校验
-void     W25QXX_WriteAutoErase(void* w_bf, uint32_t w_addr, uint16_t count);   // 写入数据自动擦除
+void     W25QXX_Write(void* w_bf, uint32_t w_addr, uint32_t count);            // 直接写入数据 自动换页 无校验
+void     W25QXX_WriteAutoErase(void* w_bf, uint32_t w_addr, uint32_t count);   // 写入数据自动擦除
 void     W25QXX_EraseSector(uint32_t address);                                 // 擦除扇区
+void     W25QXX_EraseRange(uint32_t address, uint32_t size);                   // 擦除区间 自动选择擦除粒度
 void     W25QXX_WaitBusy(void);                                                // 忙位等待
 void     W25QXX_PowerDown(void);                                               // 进入掉电模式
 void     W25QXX_WAKEUP(void);                                                  // 唤醒
@@ -1,5 +1,19 @@
 #include "spi.h"
 
+#include <stddef.h>
+
+#define SPI1_DMA_SEGMENT 0xFFFF   // DMA单次传输的最大字节数
+
+static struct {
+    const uint8_t* Tx;         // 发送数据, 为NULL时发送0xFF
+    uint8_t*       Rx;         // 接收缓冲区, 为NULL时丢弃
+    uint32_t       Count;      // 剩余字节数
+    SPI_Callback_t Callback;   // 完成回调
+    __IO uint8_t   Busy;       // DMA传输进行中
+} SPI1_Dma;
+
+static uint8_t SPI1_Dummy = 0xFF;   // 空数据
+
 /**
  * @brief  SPI1 初始化
  * @note
@@ -12,6 +26,7 @@ void SPI1_Init(void) {
     /* SPI的IO口和SPI外设打开时钟 */
     RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA, ENABLE);
     RCC_APB2PeriphClockCmd(RCC_APB2Periph_SPI1, ENABLE);
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
 
     /* SPI的IO口设置 */
     GPIO_InitStructure.GPIO_Pin   = GPIO_Pin_5 | GPIO_Pin_6 | GPIO_Pin_7;
@@ -30,7 +45,7 @@ void SPI1_Init(void) {
     SPI_InitStructure.SPI_CRCPolynomial     = 7;                                 // CRC值计算的多项式
     SPI_Init(SPI1, &SPI_InitStructure);                                          // 根据SPI_InitStruct中指定的参数初始化外设SPIx寄存器
 
-    SPI_Cmd(SPI1, ENABLE);      // 使能SPI外设
+    SPI_Cmd(SPI1, ENABLE);      // 使能SPI外设, 保持使能
     SPI1_ReadWriteByte(0xff);   // 启动传输
 }
 
@@ -48,24 +63,165 @@ void SPI1_SetSpeed(uint8_t baud) {
 
 /**
  * @brief  SPI1 读写一个字节
- * @note
+ * @note   SPI1初始化后保持使能, 不在每个字节前后开关外设
  * @param  byte: 字节
  * @retval
  */
 uint8_t SPI1_ReadWriteByte(uint8_t byte) {
-    uint8_t res = 0;
+    uint8_t  res     = 0;
     uint16_t timeout = 0x7FF;
-    SPI_Cmd(SPI1, ENABLE);
     while (SPI_I2S_GetFlagStatus(SPI1, SPI_I2S_FLAG_TXE) == RESET && timeout--) {
     }
     SPI_I2S_SendData(SPI1, byte);
     while (SPI_I2S_GetFlagStatus(SPI1, SPI_I2S_FLAG_RXNE) == RESET && timeout--) {
     }
     res = SPI_I2S_ReceiveData(SPI1);
-    SPI_Cmd(SPI1, DISABLE);
     return res;
 }
 
+/**
+ * @brief  SPI1 启动一段DMA传输
+ * @note   DMA1通道2接收, 通道3发送. 无发送数据时以固定地址发送0xFF,
+ *         无接收缓冲区时接收到固定地址丢弃
+ * @retval None
+ */
+static void SPI1_DmaSegment(void) {
+    DMA_InitTypeDef DMA_InitStructure;
+    uint16_t        count = (SPI1_Dma.Count > SPI1_DMA_SEGMENT) ? SPI1_DMA_SEGMENT : SPI1_Dma.Count;
+
+    DMA_Cmd(DMA1_Channel2, DISABLE);
+    DMA_Cmd(DMA1_Channel3, DISABLE);
+    DMA_ClearFlag(DMA1_FLAG_GL2 | DMA1_FLAG_GL3);
+
+    /* 接收通道 */
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t) &SPI1->DR;          // 外设地址
+    DMA_InitStructure.DMA_BufferSize         = count;                         // 传输字节数
+    DMA_InitStructure.DMA_PeripheralInc      = DMA_PeripheralInc_Disable;     // 外设地址不变
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;   // 外设数据8位
+    DMA_InitStructure.DMA_MemoryDataSize     = DMA_MemoryDataSize_Byte;       // 内存数据8位
+    DMA_InitStructure.DMA_Mode               = DMA_Mode_Normal;               // 单次传输
+    DMA_InitStructure.DMA_M2M                = DMA_M2M_Disable;               // 非内存到内存
+    DMA_InitStructure.DMA_DIR                = DMA_DIR_PeripheralSRC;         // 外设到内存
+    DMA_InitStructure.DMA_Priority           = DMA_Priority_VeryHigh;         // 接收优先, 避免溢出
+    if (SPI1_Dma.Rx != NULL) {
+        DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t) SPI1_Dma.Rx;
+        DMA_InitStructure.DMA_MemoryInc      = DMA_MemoryInc_Enable;
+        SPI1_Dma.Rx += count;
+    } else {
+        DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t) &SPI1_Dummy;
+        DMA_InitStructure.DMA_MemoryInc      = DMA_MemoryInc_Disable;
+    }
+    DMA_Init(DMA1_Channel2, &DMA_InitStructure);
+    DMA_ITConfig(DMA1_Channel2, DMA_IT_TC, ENABLE);
+
+    /* 发送通道 */
+    DMA_InitStructure.DMA_DIR      = DMA_DIR_PeripheralDST;   // 内存到外设
+    DMA_InitStructure.DMA_Priority = DMA_Priority_High;       // 低于接收通道
+    if (SPI1_Dma.Tx != NULL) {
+        DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t) SPI1_Dma.Tx;
+        DMA_InitStructure.DMA_MemoryInc      = DMA_MemoryInc_Enable;
+        SPI1_Dma.Tx += count;
+    } else {
+        SPI1_Dummy                           = 0xFF;
+        DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t) &SPI1_Dummy;
+        DMA_InitStructure.DMA_MemoryInc      = DMA_MemoryInc_Disable;
+    }
+    DMA_Init(DMA1_Channel3, &DMA_InitStructure);
+
+    SPI1_Dma.Count -= count;
+    SPI_I2S_DMACmd(SPI1, SPI_I2S_DMAReq_Rx | SPI_I2S_DMAReq_Tx, ENABLE);
+    DMA_Cmd(DMA1_Channel2, ENABLE);
+    DMA_Cmd(DMA1_Channel3, ENABLE);
+}
+
+/**
+ * @brief  SPI1 DMA传输完成处理
+ * @note   由DMA中断或SPI1_DmaWait调用, 本段接收完成时启动下一段或结束传输并执行回调
+ * @retval None
+ */
+static void SPI1_DmaService(void) {
+    SPI_Callback_t callback;
+
+    if ((SPI1_Dma.Busy == 0) ||
+        (DMA_GetFlagStatus(DMA1_FLAG_TC2) == RESET)) {
+        return;
+    }
+    if (SPI1_Dma.Count != 0) {
+        SPI1_DmaSegment();
+        return;
+    }
+    DMA_Cmd(DMA1_Channel2, DISABLE);
+    DMA_Cmd(DMA1_Channel3, DISABLE);
+    DMA_ClearFlag(DMA1_FLAG_GL2 | DMA1_FLAG_GL3);
+    SPI_I2S_DMACmd(SPI1, SPI_I2S_DMAReq_Rx | SPI_I2S_DMAReq_Tx, DISABLE);
+    callback          = SPI1_Dma.Callback;
+    SPI1_Dma.Callback = NULL;
+    SPI1_Dma.Busy     = 0;
+    if (callback != NULL) {
+        callback();
+    }
+}
+
+/**
+ * @brief  SPI1 启动DMA传输
+ * @note   启动后立即返回, 任意长度自动分段; 传输完成后执行回调(在中断中或SPI1_DmaWait内),
+ *         回调中可以启动下一次传输. 须等待完成后才能再访问SPI1
+ * @param  tx: 发送数据, 为NULL时发送0xFF
+ * @param  rx: 接收缓冲区, 为NULL时丢弃接收数据
+ * @param  count: 传输字节数
+ * @param  callback: 完成回调, 可为NULL
+ * @retval None
+ */
+void SPI1_DmaTransfer(const void* tx, void* rx, uint32_t count, SPI_Callback_t callback) {
+    if (count == 0) {
+        if (callback != NULL) {
+            callback();
+        }
+        return;
+    }
+    SPI1_Dma.Tx       = tx;
+    SPI1_Dma.Rx       = rx;
+    SPI1_Dma.Count    = count;
+    SPI1_Dma.Callback = callback;
+    SPI1_Dma.Busy     = 1;
+    SPI1_DmaSegment();
+}
+
+/**
+ * @brief  SPI1 等待DMA传输完成
+ * @note   查询完成标志, 在屏蔽了DMA中断的上下文(如USB中断)中也能结束传输;
+ *         未启动DMA传输时直接返回
+ * @retval None
+ */
+void SPI1_DmaWait(void) {
+    while (SPI1_Dma.Busy != 0) {
+        __disable_irq();
+        SPI1_DmaService();
+        __enable_irq();
+    }
+}
+
+/**
+ * @brief  SPI1 DMA传输是否进行中
+ * @note
+ * @retval 1: 进行中, 0: 空闲
+ */
+uint8_t SPI1_DmaBusy(void) {
+    return SPI1_Dma.Busy;
+}
+
+/**
+ * @brief  SPI1 DMA中断处理
+ * @note   在DMA1_Channel2_IRQHandler中调用, 中断由应用程序在NVIC中使能(引导程序不使能, 只查询);
+ *         与SPI1_DmaWait一样关中断处理, 避免回调发送命令时被USB中断抢占访问SPI1
+ * @retval None
+ */
+void SPI1_DmaIRQHandler(void) {
+    __disable_irq();
+    SPI1_DmaService();
+    __enable_irq();
+}
+
 /**
  * @brief  SPI2 初始化
  * @note
@@ -131,6 +287,34 @@ uint8_t SPI2_ReadWriteByte(uint8_t byte) {
     return res;
 }
 
+/**
+ * @brief  SPI2 初始化为SWD读数据移位器
+ * @note   SCK(PB13)/MISO(PB14)与SWCLK/SWDIO_I复用，引脚由SW_DP在读数据段临时切换，这里不做配置；
+ *         时钟空闲为高、下降沿采样(CPOL=1/CPHA=0)、LSB先行、16位帧；目标在上升沿改变SWDIO，
+ *         与GPIO方式在SWCLK低电平期间采样一致
+ * @param  baud: 波特率预分频
+ * @retval None
+ */
+void SPI2_SwdInit(uint16_t baud) {
+    SPI_InitTypeDef SPI_InitStructure;
+
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_SPI2, ENABLE);
+
+    SPI_Cmd(SPI2, DISABLE);
+    SPI_InitStructure.SPI_Direction         = SPI_Direction_2Lines_FullDuplex;   // 全双工, 仅使用接收
+    SPI_InitStructure.SPI_Mode              = SPI_Mode_Master;                   // 主机, 由SCK输出SWCLK
+    SPI_InitStructure.SPI_DataSize          = SPI_DataSize_16b;                  // 16位帧, 两帧移入一个字
+    SPI_InitStructure.SPI_CPOL              = SPI_CPOL_High;                     // 时钟空闲为高电平, 与SWCLK空闲状态一致
+    SPI_InitStructure.SPI_CPHA              = SPI_CPHA_1Edge;                    // 第一个跳变沿(下降沿)采样, 避开目标在上升沿的数据变化
+    SPI_InitStructure.SPI_NSS               = SPI_NSS_Soft;                      // 软件NSS
+    SPI_InitStructure.SPI_BaudRatePrescaler = baud;                              // 波特率预分频
+    SPI_InitStructure.SPI_FirstBit          = SPI_FirstBit_LSB;                  // SWD数据LSB先行
+    SPI_InitStructure.SPI_CRCPolynomial     = 7;                                 // CRC值计算的多项式
+    SPI_Init(SPI2, &SPI_InitStructure);
+
+    SPI_Cmd(SPI2, ENABLE);   // 保持使能, SCK空闲为高
+}
+
 /**
  * @brief  SPI3 初始化
  * @note
@@ -3,13 +3,20 @@
 
 #include "stm32f10x.h"
 
-void    SPI1_Init(void);                      // 初始化SPI1口
-void    SPI1_SetSpeed(uint8_t SpeedSet);      // 设置SPI1速度
-uint8_t SPI1_ReadWriteByte(uint8_t TxData);   // SPI1总线读写一个字节
+typedef void (*SPI_Callback_t)(void);   // DMA传输完成回调
+
+void    SPI1_Init(void);                                                                      // 初始化SPI1口
+void    SPI1_SetSpeed(uint8_t SpeedSet);                                                      // 设置SPI1速度
+uint8_t SPI1_ReadWriteByte(uint8_t TxData);                                                   // SPI1总线读写一个字节
+void    SPI1_DmaTransfer(const void* tx, void* rx, uint32_t count, SPI_Callback_t callback);   // SPI1启动DMA传输
+void    SPI1_DmaWait(void);                                                                   // SPI1等待DMA传输完成
+uint8_t SPI1_DmaBusy(void);                                                                   // SPI1 DMA传输是否进行中
+void    SPI1_DmaIRQHandler(void);                                                             // SPI1 DMA中断处理
 
 void    SPI2_Init(void);                      // 初始化SPI2口
 void    SPI2_SetSpeed(uint8_t SpeedSet);      // 设置SPI2速度
 uint8_t SPI2_ReadWriteByte(uint8_t TxData);   // SPI2总线读写一个字节
+void    SPI2_SwdInit(uint16_t baud);          // 初始化SPI2为SWD读数据移位器
 
 void    SPI3_Init(void);                      // 初始化SPI3口
 void    SPI3_SetSpeed(uint8_t SpeedSet);      // 设置SPI3速度
@@ -6,8 +6,14 @@
  * 0x00001000 ├─────────────────┤
  *            │  IAP Firmware   │  <- 用于对编程器进行固件升级
  * 0x00021000 ├─────────────────┤
- *            │ Program Verify  │  <- 用于对固件进行校验
- * 0x00025000 ├─────────────────┤
+ *            │ Program Verify  │  <- 用于对固件进行校验(每1K程序4字节CRC)
+ * 0x0002D000 ├─────────────────┤
+ *            │   Speed Table   │  <- SWD时钟缓存(独立扇区, 写满时清空)
+ * 0x0002E000 ├─────────────────┤
+ *            │   Free Space    │
+ * 0x00030000 ├─────────────────┤
+ *            │  Algo Package   │  <- 导入的Flash编程算法包(首扇区为索引)
+ * 0x00070000 ├─────────────────┤
  *            │                 │
  *            │   Free Space    │
  *            │                 │
@@ -20,6 +26,9 @@
  *            │   File System   │  <- 文件系统
  *            │                 │
  * 0x01000000 └─────────────────┘
+ *
+ * 超过16M的器件按容量比例放大程序区(容量的3/16, 最大12M), 其余为文件系统;
+ * 16M及以下保持上面的布局. 程序区大小在W25QXX_Init中计算, 使用时需包含SPI_Flash.h
  */
 
 #define SPI_FLASH_CONFIG_ADDRESS      (0x00000000)   // 配置保存地址
@@ -27,10 +36,16 @@
 #define SPI_FLASH_FIRMWARE_ADDRESS    (0x00001000)   // 固件保存地址
 #define SPI_FLASH_FIRMWARE_SIZE       (0x00020000)   // 固件保存大小 (128K)
 #define SPI_FLASH_VERIFY_ADDRESS      (0x00021000)   // 程序校验地址
-#define SPI_FLASH_VERIFY_SIZE         (0x00003FFF)   // 程序校验大小 (16K)
+#define SPI_FLASH_VERIFY_SIZE         (0x0000C000)   // 程序校验大小 (48K, 对应12M程序)
+#define SPI_FLASH_SPEED_ADDRESS       (0x0002D000)   // SWD时钟缓存地址
+#define SPI_FLASH_SPEED_SIZE          (0x00001000)   // SWD时钟缓存大小 (4K)
+#define SPI_FLASH_ALGO_ADDRESS        (0x00030000)   // 算法包保存地址
+#define SPI_FLASH_ALGO_SIZE           (0x00040000)   // 算法包保存大小 (256K)
 #define SPI_FLASH_PROGRAM_ADDRESS     (0x00100000)   // 程序保存地址
-#define SPI_FLASH_PROGRAM_SIZE        (0x00300000)   // 程序保存大小 (3M)
-#define SPI_FLASH_FILE_SYSTEM_ADDRESS (0x00400000)   // 文件系统地址
+#define SPI_FLASH_PROGRAM_SIZE_MIN    (0x00300000)   // 程序保存大小 (16M及以下为3M)
+#define SPI_FLASH_PROGRAM_SIZE_MAX    (0x00C00000)   // 程序保存大小上限 (64M时为12M)
+#define SPI_FLASH_PROGRAM_SIZE        (W25QXX_ReadProgramSize())   // 程序保存大小 (初始化时按容量计算)
+#define SPI_FLASH_FILE_SYSTEM_ADDRESS (SPI_FLASH_PROGRAM_ADDRESS + SPI_FLASH_PROGRAM_SIZE)   // 文件系统地址
 
 /*
  * CHIP_FLASH布局 :
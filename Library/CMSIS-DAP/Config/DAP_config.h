@@ -276,15 +276,60 @@ __STATIC_INLINE uint8_t DAP_GetProductFirmwareVersionString (char *str) {
 #define SWD_nRESET_PIN    GPIO_Pin_0
 #define SWD_nRESET_BIT    0
 
+// Gang: 多目标并行, 各目标独立SWDIO(与SWDIO同端口), 共用SWCLK与nRESET
+// 目标按SWDIO输入引脚号从小到大编号, 目标0须为SWDIO_I/SWDIO_O
+#define SWD_GANG_COUNT    1                          // 目标数, 1 = 单目标
+#define SWD_GANG_I_PORT   SWD_SWDIO_I_PORT
+#define SWD_GANG_I_PIN    SWD_SWDIO_I_PIN            // 全部目标的SWDIO输入引脚
+#define SWD_GANG_O_PORT   SWD_SWDIO_O_PORT
+#define SWD_GANG_O_PIN    SWD_SWDIO_O_PIN            // 全部目标的SWDIO输出引脚
+
+#define SWD_GANG_FIRST    0U                         // 读数据取第一个目标
+#define SWD_GANG_ALL      1U                         // 读数据取各目标按位与
+#define SWD_GANG_VOTE     2U                         // 读数据多数表决, 移除不一致的目标
+
+#if (SWD_GANG_COUNT > 1)
+extern uint32_t SWD_GangActive;                      // 在线目标(bit n对应目标n)
+extern uint8_t  SWD_GangMode;                        // 读数据归并方式
+#endif
+
+// SPI PHY: SWCLK/SWDIO_I 即 SPI2_SCK/SPI2_MISO, 读数据段由SPI2移位; 仅支持单目标
+#define SWD_SPI_PHY       (SWD_GANG_COUNT == 1)      // 1 = 使能, 0 = 仅GPIO
+#define SWD_SPI           SPI2
+#define SWD_SPI_BAUD      SPI_BaudRatePrescaler_4    // 36MHz / 4 = 9MHz
+#define SWD_SPI_CLOCK     2U                         // DAP_Data.fast_clock取此值时使用SPI PHY
+
 #define GPIO_MODE_CLR(bit)  &= ~(0xF << ((bit) * 4))
 #define GPIO_MODE_OUT(bit)  |= (0x3 << ((bit) * 4))
 #define GPIO_MODE_IN(bit)   |= (0x4 << ((bit) * 4))
 #define GPIO_MODE_HZ(bit)   |= (0x4 << ((bit) * 4))
+#define GPIO_MODE_AF(bit)   |= (0x8 << ((bit) * 4))
 
 #define GPIO_OUTPUT_H(p)    SWD_##p##_PORT->BSRR = SWD_##p##_PIN
 #define GPIO_OUTPUT_L(p)    SWD_##p##_PORT->BRR  = SWD_##p##_PIN
 #define GPIO_INPUT(p)       ((SWD_##p##_PORT->IDR & SWD_##p##_PIN) != 0)
 
+#if (SWD_GANG_COUNT > 1)
+/** Configure the mode of several pins on one port.
+\param port GPIO port.
+\param pins pin mask.
+\param mode CNF/MODE nibble.
+*/
+__STATIC_INLINE void PORT_GANG_MODE (GPIO_TypeDef *port, uint32_t pins, uint32_t mode) {
+  uint32_t bit;
+
+  for (bit = 0U; bit < 16U; bit++) {
+    if (pins & (1U << bit)) {
+      if (bit < 8U) {
+        port->CRL = (port->CRL & ~(0xFU << (bit * 4U))) | (mode << (bit * 4U));
+      } else {
+        port->CRH = (port->CRH & ~(0xFU << ((bit - 8U) * 4U))) | (mode << ((bit - 8U) * 4U));
+      }
+    }
+  }
+}
+#endif
+
 //**************************************************************************************************
 /**
 \defgroup DAP_Config_PortIO_gr CMSIS-DAP Hardware I/O Pin Access
@@ -367,6 +412,13 @@ __STATIC_INLINE void PORT_SWD_SETUP (void) {
   SWD_SWDIO_I_PORT->CRH GPIO_MODE_IN(SWD_SWDIO_I_BIT - 8);
 #endif
 
+#if (SWD_GANG_COUNT > 1)
+  /* 配置其余目标的SWDIO输出为推挽输出并输出高电平，输入为浮空输入 */
+  GPIO_OUTPUT_H(GANG_O);
+  PORT_GANG_MODE(SWD_GANG_O_PORT, SWD_GANG_O_PIN, 0x3);
+  PORT_GANG_MODE(SWD_GANG_I_PORT, SWD_GANG_I_PIN, 0x4);
+#endif
+
   /* 配置nRESET为推挽输出，并输出低电平 */
   GPIO_OUTPUT_L(nRESET);
 #if(SWD_nRESET_BIT < 8)
@@ -410,6 +462,12 @@ __STATIC_INLINE void PORT_OFF (void) {
   SWD_SWDIO_I_PORT->CRH GPIO_MODE_HZ(SWD_SWDIO_I_BIT - 8);
 #endif
 
+#if (SWD_GANG_COUNT > 1)
+  /* 配置其余目标的SWDIO为高阻态 */
+  PORT_GANG_MODE(SWD_GANG_O_PORT, SWD_GANG_O_PIN, 0x4);
+  PORT_GANG_MODE(SWD_GANG_I_PORT, SWD_GANG_I_PIN, 0x4);
+#endif
+
   /* 配置nRESET为高阻态 */
 #if(SWD_nRESET_BIT < 8)
   SWD_nRESET_PORT->CRL GPIO_MODE_CLR(SWD_nRESET_BIT);
@@ -443,6 +501,30 @@ __STATIC_FORCEINLINE void     PIN_SWCLK_TCK_CLR (void) {
   GPIO_OUTPUT_L(SWCLK);
 }
 
+#if (SWD_SPI_PHY != 0)
+/** SWCLK I/O pin: Switch to SPI mode (used by SPI PHY only).
+Hand the SWCLK pin over to the SPI SCK output (push-pull output -> alternate function).
+*/
+__STATIC_FORCEINLINE void     PIN_SWCLK_SPI_ENABLE  (void) {
+#if(SWD_SWCLK_BIT < 8)
+  SWD_SWCLK_PORT->CRL GPIO_MODE_AF(SWD_SWCLK_BIT);
+#else
+  SWD_SWCLK_PORT->CRH GPIO_MODE_AF(SWD_SWCLK_BIT - 8);
+#endif
+}
+
+/** SWCLK I/O pin: Switch back to GPIO mode (used by SPI PHY only).
+Return the SWCLK pin to push-pull output, the output latch keeps the high level.
+*/
+__STATIC_FORCEINLINE void     PIN_SWCLK_SPI_DISABLE (void) {
+#if(SWD_SWCLK_BIT < 8)
+  SWD_SWCLK_PORT->CRL &= ~(0x8 << (SWD_SWCLK_BIT * 4));
+#else
+  SWD_SWCLK_PORT->CRH &= ~(0x8 << ((SWD_SWCLK_BIT - 8) * 4));
+#endif
+}
+#endif
+
 
 // SWDIO/TMS Pin I/O --------------------------------------
 
@@ -457,14 +539,14 @@ __STATIC_FORCEINLINE uint32_t PIN_SWDIO_TMS_IN  (void) {
 Set the SWDIO/TMS DAP hardware I/O pin to high level.
 */
 __STATIC_FORCEINLINE void     PIN_SWDIO_TMS_SET (void) {
-  GPIO_OUTPUT_H(SWDIO_O);
+  GPIO_OUTPUT_H(GANG_O);
 }
 
 /** SWDIO/TMS I/O pin: Set Output to Low.
 Set the SWDIO/TMS DAP hardware I/O pin to low level.
 */
 __STATIC_FORCEINLINE void     PIN_SWDIO_TMS_CLR (void) {
-  GPIO_OUTPUT_L(SWDIO_O);
+  GPIO_OUTPUT_L(GANG_O);
 }
 
 /** SWDIO I/O pin: Get Input (used in SWD mode only).
@@ -479,9 +561,9 @@ __STATIC_FORCEINLINE uint32_t PIN_SWDIO_IN      (void) {
 */
 __STATIC_FORCEINLINE void     PIN_SWDIO_OUT     (uint32_t bit) {
   if (bit & 0x1) {
-    GPIO_OUTPUT_H(SWDIO_O);
+    GPIO_OUTPUT_H(GANG_O);
   } else {
-    GPIO_OUTPUT_L(SWDIO_O);
+    GPIO_OUTPUT_L(GANG_O);
   }
 }
 
@@ -498,7 +580,7 @@ Configure the SWDIO DAP hardware I/O pin to input mode. This function is
 called prior \ref PIN_SWDIO_IN function calls.
 */
 __STATIC_FORCEINLINE void     PIN_SWDIO_OUT_DISABLE (void) {
-  GPIO_OUTPUT_H(SWDIO_O);
+  GPIO_OUTPUT_H(GANG_O);
 }
 
 
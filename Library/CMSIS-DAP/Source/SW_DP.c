@@ -54,6 +54,28 @@
   PIN_SWCLK_SET();                      \
   PIN_DELAY()
 
+#define SW_READ_ACK(ack)                \
+  SW_READ_BIT(bit);                     \
+  ack  = bit << 0;                      \
+  SW_READ_BIT(bit);                     \
+  ack |= bit << 1;                      \
+  SW_READ_BIT(bit);                     \
+  ack |= bit << 2
+
+#define SW_READ_DATA(val, ack)          \
+  val = 0U;                             \
+  parity = 0U;                          \
+  for (n = 32U; n; n--) {               \
+    SW_READ_BIT(bit);                   \
+    parity += bit;                      \
+    val >>= 1;                          \
+    val  |= bit << 31;                  \
+  }                                     \
+  SW_READ_BIT(bit);                     \
+  if ((parity ^ bit) & 1U) {            \
+    ack = DAP_TRANSFER_ERROR;           \
+  }
+
 #define PIN_DELAY() PIN_DELAY_SLOW(DAP_Data.clock_delay)
 
 
@@ -168,29 +190,13 @@ static uint8_t SWD_Transfer##speed (uint32_t request, uint32_t *data) {
   }                                                                             \
                                                                                 \
   /* Acknowledge response */                                                    \
-  SW_READ_BIT(bit);                                                             \
-  ack  = bit << 0;                                                              \
-  SW_READ_BIT(bit);                                                             \
-  ack |= bit << 1;                                                              \
-  SW_READ_BIT(bit);                                                             \
-  ack |= bit << 2;                                                              \
+  SW_READ_ACK(ack);                                                             \
                                                                                 \
   if (ack == DAP_TRANSFER_OK) {         /* OK response */                       \
     /* Data transfer */                                                         \
     if (request & DAP_TRANSFER_RnW) {                                           \
       /* Read data */                                                           \
-      val = 0U;                                                                 \
-      parity = 0U;                                                              \
-      for (n = 32U; n; n--) {                                                   \
-        SW_READ_BIT(bit);               /* Read RDATA[0:31] */                  \
-        parity += bit;                                                          \
-        val >>= 1;                                                              \
-        val  |= bit << 31;                                                      \
-      }                                                                         \
-      SW_READ_BIT(bit);                 /* Read Parity */                       \
-      if ((parity ^ bit) & 1U) {                                                \
-        ack = DAP_TRANSFER_ERROR;                                               \
-      }                                                                         \
+      SW_READ_DATA(val, ack);           /* Read RDATA[0:31] + Parity */         \
       if (data) { *data = val; }                                                \
       /* Turnaround */                                                          \
       for (n = DAP_Data.swd_conf.turnaround; n; n--) {                          \
@@ -261,6 +267,183 @@ static uint8_t SWD_Transfer##speed (uint32_t request, uint32_t *data) {
 }
 
 
+#if ((SWD_SPI_PHY != 0) || (SWD_GANG_COUNT > 1))
+// Parity of a 32-bit word
+//   return: parity in bit 0
+static uint32_t SW_Parity (uint32_t val) {
+  val ^= val >> 16;
+  val ^= val >> 8;
+  val ^= val >> 4;
+  val ^= val >> 2;
+  val ^= val >> 1;
+  return (val);
+}
+#endif
+
+
+#if (SWD_GANG_COUNT > 1)
+
+// Gang mode: every target has its own SWDIO pin on the SWDIO port and all
+// share SWCLK. Request and write data are driven to all SWDIO outputs at
+// once, ACK and read data are sampled as whole port snapshots and then
+// demultiplexed per target. Targets that diverge from the others are
+// removed from SWD_GangActive and ignored until SWD_GangActive is reset.
+
+uint32_t SWD_GangActive = (1U << SWD_GANG_COUNT) - 1U;   // Active targets (bit n = target n)
+uint8_t  SWD_GangMode   = SWD_GANG_FIRST;                 // Read data reduction
+
+#define SW_GANG_SAMPLE(sample)          \
+  PIN_SWCLK_CLR();                      \
+  PIN_DELAY();                          \
+  sample = SWD_GANG_I_PORT->IDR;        \
+  PIN_SWCLK_SET();                      \
+  PIN_DELAY()
+
+// SWDIO input pin of a target
+//   target: target number, targets are ordered by ascending pin number
+//   return: pin mask
+static uint32_t SW_GangPin (uint32_t target) {
+  uint32_t pins = SWD_GANG_I_PIN;
+
+  while (target--) {
+    pins &= pins - 1U;
+  }
+  return (pins & (~pins + 1U));
+}
+
+// Collect the bits of one target from port snapshots
+//   sample: port snapshots, LSB first
+//   pin:    pin mask of the target
+//   count:  number of bits
+//   return: collected bits
+static uint32_t SW_GangBits (const uint32_t *sample, uint32_t pin, uint32_t count) {
+  uint32_t val = 0U;
+
+  while (count--) {
+    val = (val << 1) | ((sample[count] & pin) ? 1U : 0U);
+  }
+  return (val);
+}
+
+// Rank of an acknowledge, OK > WAIT > FAULT > protocol error
+static uint32_t SW_GangRank (uint32_t ack) {
+  switch (ack) {
+    case DAP_TRANSFER_OK:    return (3U);
+    case DAP_TRANSFER_WAIT:  return (2U);
+    case DAP_TRANSFER_FAULT: return (1U);
+    default:                 return (0U);
+  }
+}
+
+// Demultiplex the acknowledge of all active targets
+//   sample: port snapshots of ACK[0:2]
+//   return: best acknowledge, targets answering otherwise are removed
+static uint32_t SW_GangAck (const uint32_t *sample) {
+  uint32_t ack[SWD_GANG_COUNT];
+  uint32_t best = 0x7U;
+  uint32_t n;
+
+  for (n = 0U; n < SWD_GANG_COUNT; n++) {
+    if (SWD_GangActive & (1U << n)) {
+      ack[n] = SW_GangBits(sample, SW_GangPin(n), 3U);
+      if (SW_GangRank(ack[n]) > SW_GangRank(best)) {
+        best = ack[n];
+      }
+    }
+  }
+  if (SW_GangRank(best) == 0U) {
+    return (best);                      /* No target answered */
+  }
+  for (n = 0U; n < SWD_GANG_COUNT; n++) {
+    if ((SWD_GangActive & (1U << n)) && (ack[n] != best)) {
+      SWD_GangActive &= ~(1U << n);
+    }
+  }
+  return (best);
+}
+
+// Demultiplex the read data of all active targets
+//   sample: port snapshots of RDATA[0:31] and parity
+//   data:   reduced data according to SWD_GangMode
+//   return: DAP_TRANSFER_OK, or DAP_TRANSFER_ERROR when no target passed parity
+static uint32_t SW_GangRead (const uint32_t *sample, uint32_t *data) {
+  uint32_t val[SWD_GANG_COUNT];
+  uint32_t valid = 0U;
+  uint32_t best, votes, count;
+  uint32_t n, k, pin;
+
+  for (n = 0U; n < SWD_GANG_COUNT; n++) {
+    if (SWD_GangActive & (1U << n)) {
+      pin    = SW_GangPin(n);
+      val[n] = SW_GangBits(sample, pin, 32U);
+      if (((SW_Parity(val[n]) ^ SW_GangBits(&sample[32], pin, 1U)) & 1U) == 0U) {
+        valid |= 1U << n;
+      }
+    }
+  }
+  if (valid == 0U) {
+    return (DAP_TRANSFER_ERROR);
+  }
+  SWD_GangActive = valid;               /* Parity error: remove target */
+
+  for (best = 0U; (valid & (1U << best)) == 0U; best++);
+  if (SWD_GangMode == SWD_GANG_ALL) {
+    for (n = best + 1U; n < SWD_GANG_COUNT; n++) {
+      if (valid & (1U << n)) {
+        val[best] &= val[n];
+      }
+    }
+  } else if (SWD_GangMode == SWD_GANG_VOTE) {
+    votes = 0U;
+    for (n = 0U; n < SWD_GANG_COUNT; n++) {
+      if ((valid & (1U << n)) == 0U) {
+        continue;
+      }
+      for (k = 0U, count = 0U; k < SWD_GANG_COUNT; k++) {
+        if ((valid & (1U << k)) && (val[k] == val[n])) {
+          count++;
+        }
+      }
+      if (count > votes) {
+        best  = n;
+        votes = count;
+      }
+    }
+    for (n = 0U; n < SWD_GANG_COUNT; n++) {
+      if ((valid & (1U << n)) && (val[n] != val[best])) {
+        SWD_GangActive &= ~(1U << n);   /* Outvoted: remove target */
+      }
+    }
+  }
+  *data = val[best];
+  return (DAP_TRANSFER_OK);
+}
+
+#undef  SW_READ_ACK
+#define SW_READ_ACK(ack)                \
+  {                                     \
+    uint32_t sample[3];                 \
+    SW_GANG_SAMPLE(sample[0]);          \
+    SW_GANG_SAMPLE(sample[1]);          \
+    SW_GANG_SAMPLE(sample[2]);          \
+    ack = SW_GangAck(sample);           \
+  }
+
+#undef  SW_READ_DATA
+#define SW_READ_DATA(val, ack)          \
+  {                                     \
+    uint32_t sample[33];                \
+    for (n = 0U; n < 33U; n++) {        \
+      SW_GANG_SAMPLE(sample[n]);        \
+    }                                   \
+    if (SW_GangRead(sample, &val) != DAP_TRANSFER_OK) { \
+      ack = DAP_TRANSFER_ERROR;         \
+    }                                   \
+  }
+
+#endif  /* (SWD_GANG_COUNT > 1) */
+
+
 #undef  PIN_DELAY
 #define PIN_DELAY() PIN_DELAY_FAST()
 SWD_TransferFunction(Fast)
@@ -270,11 +453,54 @@ SWD_TransferFunction(Fast)
 SWD_TransferFunction(Slow)
 
 
+#if (SWD_SPI_PHY != 0)
+
+// Read RDATA[0:31] through SPI
+//   SWCLK is handed over to SPI SCK, two 16-bit LSB-first frames are
+//   clocked in while SWDIO is sampled on MISO at the falling edge of SWCLK
+//   (the target changes SWDIO on the rising edge); the clock idles high.
+//   return: RDATA[31:0]
+static uint32_t SW_ReadDataSpi (void) {
+  uint32_t val;
+
+  PIN_SWCLK_SPI_ENABLE();
+  SWD_SPI->DR = 0U;
+  while ((SWD_SPI->SR & SPI_SR_RXNE) == 0U);
+  val  = SWD_SPI->DR;
+  SWD_SPI->DR = 0U;
+  while ((SWD_SPI->SR & SPI_SR_RXNE) == 0U);
+  val |= (uint32_t)SWD_SPI->DR << 16;
+  while ((SWD_SPI->SR & SPI_SR_BSY) != 0U);
+  PIN_SWCLK_SPI_DISABLE();
+
+  return (val);
+}
+
+#undef  SW_READ_DATA
+#define SW_READ_DATA(val, ack)          \
+  val = SW_ReadDataSpi();               \
+  SW_READ_BIT(bit);                     \
+  if ((SW_Parity(val) ^ bit) & 1U) {    \
+    ack = DAP_TRANSFER_ERROR;           \
+  }
+
+#undef  PIN_DELAY
+#define PIN_DELAY() PIN_DELAY_FAST()
+SWD_TransferFunction(Spi)
+
+#endif  /* (SWD_SPI_PHY != 0) */
+
+
 // SWD Transfer I/O
 //   request: A[3:2] RnW APnDP
 //   data:    DATA[31:0]
 //   return:  ACK[2:0]
 uint8_t  SWD_Transfer(uint32_t request, uint32_t *data) {
+#if (SWD_SPI_PHY != 0)
+  if (DAP_Data.fast_clock == SWD_SPI_CLOCK) {
+    return SWD_TransferSpi(request, data);
+  }
+#endif
   if (DAP_Data.fast_clock) {
     return SWD_TransferFast(request, data);
   } else {
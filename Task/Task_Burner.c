@@ -6,6 +6,7 @@
 #include "SPI_Flash.h"
 #include "SWD_flash.h"
 #include "SWD_host.h"
+#include "Tool.h"
 #include "buzzer.h"
 #include "heap.h"
 #include "hw_config.h"
@@ -14,21 +15,471 @@
 extern uint32_t SysTick_Get(void);   // 获取系统滴答计数值
 extern void     Delay(uint32_t);     // 获取系统滴答计数值
 
+typedef struct {
+    uint8_t* Data;     // 数据缓冲区
+    uint32_t Offset;   // 镜像内偏移
+    uint32_t Size;     // 字节数
+} Burner_Chunk_t;
+
+typedef error_t (*Burner_Stage_t)(Burner_Chunk_t* chunk);   // 编程流水线的处理阶段
+
 BurnerCtrl_t BurnerCtrl = {
     .StartTimer = BURNER_AUTO_START_TIME,
     .EndTimer   = BURNER_AUTO_END_TIME,
 };
 
 /**
- * @brief  检测目标
+ * @brief  计算时钟缓存项校验
  * @note
+ * @param  speed: 时钟缓存项
+ * @retval 校验值
+ */
+static uint8_t Burner_SpeedCheck(Burner_Speed_t* speed) {
+    return ~(speed->DevId ^ (speed->DevId >> 8) ^ speed->Clock);
+}
+
+/**
+ * @brief  读取缓存的SWD时钟
+ * @note   缓存项顺序追加, 同一设备以最后一项为准
+ * @param  dev_id: 设备ID
+ * @retval 时钟档位, 无缓存时返回SWD_CLOCK_DEFAULT
+ */
+static uint8_t Burner_SpeedLoad(uint16_t dev_id) {
+    Burner_Speed_t speed[16];
+    uint8_t        clock = SWD_CLOCK_DEFAULT;
+
+    for (uint32_t addr = 0; addr < SPI_FLASH_SPEED_SIZE; addr += sizeof(speed)) {
+        SPI_FLASH_Read(speed, SPI_FLASH_SPEED_ADDRESS + addr, sizeof(speed));
+        for (uint8_t i = 0; i < ArraySize(speed); i++) {
+            if (speed[i].DevId == 0xFFFF) {
+                return clock;   // 已到末尾
+            }
+            if ((speed[i].DevId == dev_id) &&
+                (speed[i].Check == Burner_SpeedCheck(&speed[i]))) {
+                clock = speed[i].Clock;
+            }
+        }
+    }
+    return clock;
+}
+
+/**
+ * @brief  保存SWD时钟到缓存
+ * @note   追加到第一个空项, 缓存已满时擦除缓存扇区后从头写入
+ * @param  dev_id: 设备ID
+ * @param  clock: 时钟档位
+ * @retval None
+ */
+static void Burner_SpeedSave(uint16_t dev_id, uint8_t clock) {
+    Burner_Speed_t speed = {.DevId = dev_id, .Clock = clock};
+    uint32_t       addr;
+    uint16_t       tmp;
+
+    speed.Check = Burner_SpeedCheck(&speed);
+    for (addr = 0; addr < SPI_FLASH_SPEED_SIZE; addr += sizeof(speed)) {
+        SPI_FLASH_Read(&tmp, SPI_FLASH_SPEED_ADDRESS + addr, sizeof(tmp));
+        if (tmp == 0xFFFF) {
+            break;
+        }
+    }
+    if (addr >= SPI_FLASH_SPEED_SIZE) {
+        /* 缓存已满 */
+        addr = 0;
+        SPI_FLASH_Erase(SPI_FLASH_SPEED_ADDRESS);
+    }
+    SPI_FLASH_Write(&speed, SPI_FLASH_SPEED_ADDRESS + addr, sizeof(speed));
+}
+
+/**
+ * @brief  计算本包读写字节数
+ * @note
+ * @param  offset: 已完成的字节数
+ * @retval 本包字节数
+ */
+static uint32_t Burner_ChunkSize(uint32_t offset) {
+    if ((BurnerCtrl.Info.ProgramSize - offset) > CONFIG_BUFFER_SIZE) {
+        /* 检查剩余字节数,若剩余字节大于缓存,读取缓存大小文件 */
+        return CONFIG_BUFFER_SIZE;
+    }
+    /* 剩余字节数大于0小于缓存,读取剩余字节数 */
+    return BurnerCtrl.Info.ProgramSize - offset;
+}
+
+/**
+ * @brief  转换Flash操作错误码
+ * @note   超时单独上报, 其余错误使用操作对应的错误码
+ * @param  status: Flash操作返回值
+ * @param  error: 操作失败对应的错误码
+ * @retval 烧录错误码
+ */
+static Burner_Error_t Burner_FlashError(error_t status, Burner_Error_t error) {
+    if (status == ERROR_TIMEOUT) {
+        return BURNER_ERROR_FLASH_TIMEOUT;
+    }
+    return error;
+}
+
+/**
+ * @brief  记录被移出的并行目标的错误码
+ * @note   多目标并行烧录时, 本阶段中应答或返回值与其他目标不一致的目标会被移出,
+ *         记录为本阶段的错误码; 单目标时无操作
+ * @param  error: 本阶段对应的错误码
+ * @retval None
+ */
+static void Burner_GangCheck(Burner_Error_t error) {
+    uint32_t active = swd_gang_active();
+    for (uint8_t i = 0; i < SWD_GANG_COUNT; i++) {
+        if (((active & (1 << i)) == 0) && (BurnerCtrl.GangError[i] == BURNER_ERROR_NONE)) {
+            BurnerCtrl.GangError[i] = error;
+        }
+    }
+}
+
+/**
+ * @brief  汇总各目标的烧录结果
+ * @note   整体失败时仍在线的目标记为该错误; 整体成功但有目标被移出时,
+ *         以第一个失败目标的错误码作为本次结果
+ * @retval None
+ */
+static void Burner_GangResult(void) {
+    uint32_t active = swd_gang_active();
+    for (uint8_t i = 0; i < SWD_GANG_COUNT; i++) {
+        if ((BurnerCtrl.Error != BURNER_ERROR_NONE) && (active & (1 << i))) {
+            BurnerCtrl.GangError[i] = BurnerCtrl.Error;
+        }
+    }
+    for (uint8_t i = 0; (i < SWD_GANG_COUNT) && (BurnerCtrl.Error == BURNER_ERROR_NONE); i++) {
+        BurnerCtrl.Error = BurnerCtrl.GangError[i];
+    }
+}
+
+/**
+ * @brief  写入一段CRC表
+ * @note   把镜像[offset, offset + size)对应的分块CRC从SPI Flash写入目标的编程缓冲区
+ * @param  offset: 镜像内偏移, 须为分块大小的整数倍
+ * @param  size: 字节数
+ * @retval ERROR_SUCCESS: 成功, 其他: 失败错误码
+ */
+static error_t Burner_CrcLoad(uint32_t offset, uint32_t size) {
+    uint32_t f_addr = SPI_FLASH_VERIFY_ADDRESS + offset / CONFIG_BUFFER_SIZE * 4;
+    uint32_t total  = (size + CONFIG_BUFFER_SIZE - 1) / CONFIG_BUFFER_SIZE * 4;   // CRC表字节数
+    error_t  status;
+
+    for (uint32_t i = 0; i < total; i += CONFIG_BUFFER_SIZE) {
+        uint32_t rw_cnt = total - i;
+        if (rw_cnt > CONFIG_BUFFER_SIZE) {
+            rw_cnt = CONFIG_BUFFER_SIZE;
+        }
+        SPI_FLASH_Read(BurnerCtrl.Buffer, f_addr + i, rw_cnt);
+        if ((status = target_flash_crc_table(i, BurnerCtrl.Buffer, rw_cnt)) != ERROR_SUCCESS) {
+            return status;
+        }
+    }
+
+    return ERROR_SUCCESS;
+}
+
+/**
+ * @brief  按CRC表校验Flash
+ * @note   每次把一段CRC表写入目标的编程缓冲区, 由目标一次校验对应的所有分块
+ * @retval ERROR_SUCCESS: 成功, 其他: 失败错误码
+ */
+static error_t Burner_VerifyTable(void) {
+    uint32_t limit = target_flash_crc_capacity() / 4 * CONFIG_BUFFER_SIZE;   // 单次校验的最大字节数
+    uint32_t count;                                                          // 校验一致的块数
+    error_t  status;
+
+    while (BurnerCtrl.Info.ProgramSize - BurnerCtrl.Info.FinishSize) {
+        uint32_t size = BurnerCtrl.Info.ProgramSize - BurnerCtrl.Info.FinishSize;
+        if (size > limit) {
+            size = limit;
+        }
+        /* 写入本段CRC表 */
+        if ((status = Burner_CrcLoad(BurnerCtrl.Info.FinishSize, size)) != ERROR_SUCCESS) {
+            return status;
+        }
+        LED_OnOff(RUN);
+        /* 校验本段 */
+        if ((status = target_flash_crc_check(BurnerConfigInfo.FlashAddress + BurnerCtrl.Info.FinishSize,
+                                             size,
+                                             CONFIG_BUFFER_SIZE,
+                                             0,
+                                             &count)) != ERROR_SUCCESS) {
+            BurnerCtrl.Info.FinishSize += count * CONFIG_BUFFER_SIZE;   // 定位到不一致的分块
+            return status;
+        }
+        BurnerCtrl.Info.FinishSize += size;
+        BurnerCtrl.Info.FinishRate = BurnerCtrl.Info.FinishSize * 1000 / BurnerCtrl.Info.ProgramSize;
+    }
+
+    return ERROR_SUCCESS;
+}
+
+/**
+ * @brief  查找需要更新的扇区
+ * @note   增量烧录时在擦除前由目标按CRC表校验现有内容, 存在不一致分块的扇区整体标记为需更新;
+ *         分块与扇区边界不对齐时整段标记为需更新
+ * @retval ERROR_SUCCESS: 成功, 其他: 失败, 此时按全部更新处理
+ */
+static error_t Burner_DeltaScan(void) {
+    uint32_t limit  = target_flash_crc_capacity() / 4 * CONFIG_BUFFER_SIZE;                           // 单次校验的最大字节数
+    uint32_t chunks = (BurnerCtrl.Info.ProgramSize + CONFIG_BUFFER_SIZE - 1) / CONFIG_BUFFER_SIZE;   // 分块数
+    uint32_t offset = 0;                                                                             // 本段起始偏移
+    uint32_t pos;                                                                                    // 本段内的校验位置
+    uint32_t count;                                                                                  // 校验一致的块数
+    error_t  status;
+
+    if (limit == 0) {
+        return ERROR_FAILURE;
+    }
+    if ((BurnerCtrl.DeltaMap = pvPortMalloc((chunks + 7) / 8)) == NULL) {
+        return ERROR_FAILURE;
+    }
+    memset(BurnerCtrl.DeltaMap, 0, (chunks + 7) / 8);
+
+    while (offset < BurnerCtrl.Info.ProgramSize) {
+        uint32_t size = BurnerCtrl.Info.ProgramSize - offset;
+        if (size > limit) {
+            size = limit;
+        }
+        if ((status = Burner_CrcLoad(offset, size)) != ERROR_SUCCESS) {
+            return status;
+        }
+        LED_OnOff(RUN);
+        for (pos = offset; pos < offset + size;) {
+            status = target_flash_crc_check(BurnerConfigInfo.FlashAddress + pos,
+                                            offset + size - pos,
+                                            CONFIG_BUFFER_SIZE,
+                                            (pos - offset) / CONFIG_BUFFER_SIZE * 4,
+                                            &count);
+            if (status == ERROR_SUCCESS) {
+                pos = offset + size;
+                break;
+            }
+            if (status != ERROR_VERIFY) {
+                return status;
+            }
+            /* 不一致分块所在的扇区整体需要擦除重写 */
+            pos += count * CONFIG_BUFFER_SIZE;
+            while ((pos > 0) && (target_flash_sector_integer(BurnerConfigInfo.FlashAddress + pos) == 0)) {
+                pos -= CONFIG_BUFFER_SIZE;
+            }
+            do {
+                BurnerCtrl.DeltaMap[pos / CONFIG_BUFFER_SIZE / 8] |= 1 << (pos / CONFIG_BUFFER_SIZE % 8);
+                pos += CONFIG_BUFFER_SIZE;
+            } while ((pos < BurnerCtrl.Info.ProgramSize) &&
+                     (target_flash_sector_integer(BurnerConfigInfo.FlashAddress + pos) == 0));
+        }
+        offset = pos;
+    }
+
+    return ERROR_SUCCESS;
+}
+
+/**
+ * @brief  判断分块是否需要擦写
+ * @note   未进行增量扫描时全部需要擦写
+ * @param  offset: 分块在镜像内的偏移
+ * @retval 1: 需要, 0: 内容已一致
+ */
+static uint8_t Burner_DeltaDirty(uint32_t offset) {
+    if (BurnerCtrl.DeltaMap == NULL) {
+        return 1;
+    }
+    offset /= CONFIG_BUFFER_SIZE;
+    return (BurnerCtrl.DeltaMap[offset / 8] >> (offset % 8)) & 1;
+}
+
+/**
+ * @brief  查找下一个需要编程的分块
+ * @note
+ * @param  offset: 查找起始偏移
+ * @retval 分块偏移, 没有时返回镜像大小
+ */
+static uint32_t Burner_NextChunk(uint32_t offset) {
+    while ((offset < BurnerCtrl.Info.ProgramSize) && (Burner_DeltaDirty(offset) == 0)) {
+        offset += CONFIG_BUFFER_SIZE;
+    }
+    if (offset > BurnerCtrl.Info.ProgramSize) {
+        offset = BurnerCtrl.Info.ProgramSize;
+    }
+    return offset;
+}
+
+/**
+ * @brief  编程阶段
+ * @note   写入目标的编程缓冲区并启动页编程, 目标编程期间返回
+ * @param  chunk: 分块
+ * @retval ERROR_SUCCESS: 成功, 其他: 失败错误码
+ */
+static error_t Burner_StageProgram(Burner_Chunk_t* chunk) {
+    return target_flash_program_page(BurnerConfigInfo.FlashAddress + chunk->Offset,
+                                     chunk->Data,
+                                     chunk->Size);
+}
+
+// 分块读取完成后依次执行的处理阶段, 解压、补丁等阶段插入在编程阶段之前
+static const Burner_Stage_t BurnerStage[] = {
+    Burner_StageProgram,
+};
+
+/**
+ * @brief  流水线编程
+ * @note   两个缓冲区交替使用: 当前分块依次经过各处理阶段时, DMA从SPI Flash读取下一个分块,
+ *         SPI读取时间隐藏在SWD传输时间内. 返回时最后一页可能仍在编程, 需调用target_flash_sync
+ * @param  prefetch: 偏移0的分块已读入第一个缓冲区
+ * @retval ERROR_SUCCESS: 成功, 其他: 失败错误码
+ */
+static error_t Burner_Program(uint8_t prefetch) {
+    Burner_Chunk_t chunk[2];
+    uint8_t        index = 0;   // 当前分块
+    error_t        status;
+
+    chunk[0].Data   = BurnerCtrl.Buffer;
+    chunk[1].Data   = BurnerCtrl.Buffer + CONFIG_BUFFER_SIZE;
+    chunk[0].Offset = Burner_NextChunk(0);
+    chunk[0].Size   = Burner_ChunkSize(chunk[0].Offset);
+    if ((chunk[0].Offset < BurnerCtrl.Info.ProgramSize) &&
+        ((prefetch == 0) || (chunk[0].Offset != 0))) {
+        SPI_FLASH_ReadStart(chunk[0].Data,
+                            BurnerConfigInfo.FileAddress + chunk[0].Offset,
+                            chunk[0].Size);
+    }
+    while (chunk[index].Offset < BurnerCtrl.Info.ProgramSize) {
+        Burner_Chunk_t* cur  = &chunk[index];
+        Burner_Chunk_t* next = &chunk[index ^ 1];
+        /* 等待当前分块读取完成, 启动下一个分块的读取 */
+        SPI_FLASH_ReadWait();
+        next->Offset = Burner_NextChunk(cur->Offset + cur->Size);
+        next->Size   = Burner_ChunkSize(next->Offset);
+        if (next->Offset < BurnerCtrl.Info.ProgramSize) {
+            SPI_FLASH_ReadStart(next->Data,
+                                BurnerConfigInfo.FileAddress + next->Offset,
+                                next->Size);
+        }
+        /* 当前分块依次经过各处理阶段 */
+        for (uint8_t i = 0; i < ArraySize(BurnerStage); i++) {
+            if ((status = BurnerStage[i](cur)) != ERROR_SUCCESS) {
+                SPI_FLASH_ReadWait();
+                return status;
+            }
+        }
+        BurnerCtrl.Info.FinishSize = cur->Offset + cur->Size;
+        BurnerCtrl.Info.FinishRate = BurnerCtrl.Info.FinishSize * 1000 / BurnerCtrl.Info.ProgramSize;
+        LED_OnOff(RUN);
+        index ^= 1;
+    }
+    BurnerCtrl.Info.FinishSize = BurnerCtrl.Info.ProgramSize;
+    BurnerCtrl.Info.FinishRate = 1000;
+
+    return ERROR_SUCCESS;
+}
+
+/**
+ * @brief  获取Flash编程并行位数
+ * @note   配置了有效的programParallelism时直接使用, 否则取电压范围允许的最大位数
+ * @retval 并行位数
+ */
+static uint8_t Burner_Parallelism(void) {
+    static const uint8_t range[] = {32, 8, 16, 32, 64};   // 各电压范围允许的最大位数, 无效时按2.7V~3.6V
+
+    switch (BurnerConfigInfo.Parallelism) {
+        case 8:
+        case 16:
+        case 32:
+        case 64:
+            return BurnerConfigInfo.Parallelism;
+        default:
+            break;
+    }
+    if (BurnerConfigInfo.VoltageRange < sizeof(range)) {
+        return range[BurnerConfigInfo.VoltageRange];
+    }
+    return range[0];
+}
+
+/**
+ * @brief  检查选项字节是否为默认状态
+ * @note   按设备表读取选项字状态寄存器. 设备表未描述或多目标并行时(读数据只取第一个目标)
+ *         无法确认, 按需要复位处理
+ * @retval 1: 未开启读写保护且为默认选项字, 0: 需要复位选项字节
+ */
+static uint8_t Burner_OptionDefault(void) {
+    const option_check_t* check = BurnerCtrl.FlashBlob->OptCheck;
+    uint32_t              value;
+
+    if ((SWD_GANG_COUNT > 1) || (check[0].addr == 0)) {
+        return 0;
+    }
+    for (uint8_t i = 0; (i < 2) && (check[i].addr != 0); i++) {
+        if ((swd_read_memory(check[i].addr, (void*) &value, 4) != 0) ||
+            ((value & check[i].mask) != check[i].value)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief  擦除待编程的扇区
+ * @note   连续需要擦写的分块合并为一段, 由目标一次擦除一段内的全部扇区;
+ *         擦除期间预读第一包编程数据
+ * @param  prefetch: 返回第一包数据是否已预读
+ * @retval ERROR_SUCCESS: 成功, 其他: 失败错误码
+ */
+static error_t Burner_EraseSectors(uint8_t* prefetch) {
+    uint32_t start = 0;   // 本段起始偏移
+    uint32_t end;         // 本段结束偏移
+    error_t  status;
+
+    while (start < BurnerCtrl.Info.ProgramSize) {
+        if (Burner_DeltaDirty(start) == 0) {
+            start += CONFIG_BUFFER_SIZE;
+            continue;
+        }
+        end = start + CONFIG_BUFFER_SIZE;
+        while ((end < BurnerCtrl.Info.ProgramSize) && (Burner_DeltaDirty(end) != 0)) {
+            end += CONFIG_BUFFER_SIZE;
+        }
+        if (end > BurnerCtrl.Info.ProgramSize) {
+            end = BurnerCtrl.Info.ProgramSize;
+        }
+        if ((status = target_flash_erase_range_start(BurnerConfigInfo.FlashAddress + start,
+                                                     end - start)) != ERROR_SUCCESS) {
+            return status;
+        }
+        if (*prefetch == 0) {
+            /* 查询结果后擦除状态即被清除, 擦除已失败时须在此返回错误 */
+            if ((status = target_flash_poll()) == ERROR_BUSY) {
+                SPI_FLASH_Read(BurnerCtrl.Buffer,
+                               BurnerConfigInfo.FileAddress,
+                               Burner_ChunkSize(0));
+                *prefetch = 1;
+            } else if (status != ERROR_SUCCESS) {
+                return status;
+            }
+        }
+        LED_OnOff(RUN);
+        if ((status = target_flash_sync()) != ERROR_SUCCESS) {
+            return status;
+        }
+        start = end;
+    }
+
+    return ERROR_SUCCESS;
+}
+
+/**
+ * @brief  检测目标
+ * @note   离线时只做线复位和读IDCODE的轻量探测, 完整的调试接口初始化在开始烧录时进行
  * @retval None
  */
 void Burner_Detection(void) {
     if (BurnerCtrl.Online != 0) {
         BurnerCtrl.Online = (swd_read_idcode(&BurnerCtrl.Info.ChipIdcode) == 0);
     } else {
-        BurnerCtrl.Online = (swd_init_debug() == 0);
+        swd_gang_reset();
+        BurnerCtrl.Online = (swd_probe(&BurnerCtrl.Info.ChipIdcode) == 0);
     }
 
     switch (BurnerCtrl.State) {
@@ -82,10 +533,20 @@ void Burner_Detection(void) {
  * @retval None
  */
 void Burner_Exe(void) {
-    uint32_t tick = SysTick_Get();
-    uint8_t  rdp  = 0;
+    uint32_t tick  = SysTick_Get();
+    uint8_t  rdp   = 0;
+    uint8_t  clock = SWD_CLOCK_DEFAULT;
+    uint8_t  prefetch;   // 第一包数据已预读
+    error_t  status;     // Flash操作返回值
     if (USB_StateGet() != 0) {
         BurnerCtrl.State = BURNER_STATE_LOCK;
+        /* U盘模式下释放烧录缓冲区, 留给U盘回写缓存 */
+        if (BurnerCtrl.Buffer != NULL) {
+            NVIC_DisableIRQ(USB_LP_CAN1_RX0_IRQn);
+            vPortFree(BurnerCtrl.Buffer);
+            BurnerCtrl.Buffer = NULL;
+            NVIC_EnableIRQ(USB_LP_CAN1_RX0_IRQn);
+        }
         return;
     }
     /* 等待开始命令 */
@@ -102,7 +563,7 @@ void Burner_Exe(void) {
     LED_Off(ERR);
     /* 分配缓存 */
     if (BurnerCtrl.Buffer == NULL) {
-        if ((BurnerCtrl.Buffer = pvPortMalloc(CONFIG_BUFFER_SIZE)) == NULL) {
+        if ((BurnerCtrl.Buffer = pvPortMalloc(CONFIG_BUFFER_SIZE * 2)) == NULL) {
             BurnerCtrl.Error = BURNER_ERROR_BUFFER;   // 缓存分配失败
             goto exit;                                // 初始化失败
         }
@@ -110,7 +571,11 @@ void Burner_Exe(void) {
     /* 蜂鸣器短鸣 */
     Beep(150);
 start:
-    /* 初始化接口 */
+    prefetch = 0;
+    swd_gang_reset();
+    memset(&BurnerCtrl.GangError, 0, sizeof(BurnerCtrl.GangError));
+    /* 以默认时钟初始化接口 */
+    swd_set_clock(SWD_CLOCK_DEFAULT);
     if (swd_init_debug() != 0) {
         BurnerCtrl.Error = BURNER_ERROR_INIT;   // SWD初始化失败
         goto exit;                              // 初始化失败
@@ -135,49 +600,59 @@ start:
         BurnerCtrl.Error = BURNER_ERROR_CHIP_UNKNOWN;   // SWD初始化失败
         goto exit;                                      // 初始化失败
     }
-
-    if (swd_read_memory(BurnerCtrl.FlashBlob->FlashSizeAddr,
-                        (void*) &BurnerCtrl.Info.FlashSize,
-                        2) != 0) {
-        rdp++;   // 读取Flash大小失败 可能开启了rdp
+    Burner_GangCheck(BURNER_ERROR_INIT);
+    /* 设置SWD时钟, 重试时重新校准 */
+    clock = (BurnerCtrl.ErrCnt == 0) ? Burner_SpeedLoad(BurnerCtrl.Info.DEV_ID) : SWD_CLOCK_DEFAULT;
+    if (clock != SWD_CLOCK_DEFAULT) {
+        swd_set_clock(clock);
+    } else if (swd_clock_calibrate(0x20000000, &clock) == 0) {
+        Burner_SpeedSave(BurnerCtrl.Info.DEV_ID, clock);
+    } else if (swd_init_debug() != 0) {
+        BurnerCtrl.Error = BURNER_ERROR_INIT;   // SWD初始化失败
+        goto exit;                              // 初始化失败
     }
 
     /* 初步匹配编程算法 */
-    BurnerCtrl.FlashBlob = FlashBlob_Get(BurnerCtrl.Info.DEV_ID & 0xFFF, 0);
+    BurnerCtrl.FlashBlob = FlashBlob_Get(BurnerCtrl.Info.DEV_ID & 0xFFF, 0, 0);
     if (BurnerCtrl.FlashBlob == NULL) {
         BurnerCtrl.Error = BURNER_ERROR_CHIP_UNKNOWN;   // SWD初始化失败
         goto exit;                                      // 初始化失败
     }
-    /* 初始化选项字节编程算法 */
-    if (target_flash_init(BurnerCtrl.FlashBlob->prog_opt, 0) != ERROR_SUCCESS) {
-        BurnerCtrl.Error = BURNER_ERROR_OPT_INIT;   // 选项字初始化失败
-        goto exit;                                  // 初始化失败
-    }
-    LED_On(RUN);
-    /* 复位选项字节 */
-    if (target_flash_erase_chip() != ERROR_SUCCESS) {
-        BurnerCtrl.Error = BURNER_ERROR_OPT_ERASE;   // 选项字擦除失败
-        goto exit;                                   // 擦除失败
+    if (swd_read_memory(BurnerCtrl.FlashBlob->FlashSizeAddr,
+                        (void*) &BurnerCtrl.Info.FlashSize,
+                        2) != 0) {
+        rdp++;   // 读取Flash大小失败 可能开启了rdp
     }
-    LED_Off(RUN);
-    /* 反初始化选项字节编程算法 */
-    target_flash_uninit();
 
-    /* 等待响应 */
-    for (uint16_t i = 0; i < 200; i++) {
-        Delay(10);
-        /* 初始化接口 */
-        if (swd_init_debug() != 0) {
-            continue;
+    /* 开启了读写保护或选项字不是默认值时才复位选项字节 */
+    if ((rdp != 0) || (Burner_OptionDefault() == 0)) {
+        /* 初始化选项字节编程算法 */
+        if (target_flash_init(BurnerCtrl.FlashBlob->prog_opt, 0, BurnerCtrl.FlashBlob->RamSize * 1024) != ERROR_SUCCESS) {
+            BurnerCtrl.Error = BURNER_ERROR_OPT_INIT;   // 选项字初始化失败
+            goto exit;                                  // 初始化失败
         }
-        LED_OnOff(RUN);
-        /* 获取Flash大小 */
-        if (swd_read_memory(BurnerCtrl.FlashBlob->FlashSizeAddr,
-                            (void*) &BurnerCtrl.Info.FlashSize,
-                            2) == 0) {
+        LED_On(RUN);
+        /* 复位选项字节 */
+        if (target_flash_erase_chip() != ERROR_SUCCESS) {
+            BurnerCtrl.Error = BURNER_ERROR_OPT_ERASE;   // 选项字擦除失败
+            goto exit;                                   // 擦除失败
+        }
+        LED_Off(RUN);
+        Burner_GangCheck(BURNER_ERROR_OPT_ERASE);
+        /* 反初始化选项字节编程算法 */
+        target_flash_uninit();
+
+        /* 等待目标重载选项字后重新连接, 以能读取Flash大小寄存器为就绪 */
+        LED_On(RUN);
+        if ((swd_reconnect(BurnerCtrl.FlashBlob->FlashSizeAddr & ~0x3,
+                           (BurnerCtrl.FlashBlob->ReconnectTime != 0) ? BurnerCtrl.FlashBlob->ReconnectTime : BURNER_RECONNECT_TIME,
+                           &BurnerCtrl.Info.ReconnectTime) == 0) &&
+            (swd_read_memory(BurnerCtrl.FlashBlob->FlashSizeAddr,
+                             (void*) &BurnerCtrl.Info.FlashSize,
+                             2) == 0)) {
             rdp++;   // 读取Flash大小成功
-            break;
         }
+        LED_Off(RUN);
     }
     if ((BurnerCtrl.Info.FlashSize == 0) ||
         (BurnerCtrl.Info.FlashSize == 0xFFFF)) {
@@ -185,7 +660,9 @@ start:
         goto exit;                                    // 初始化失败
     }
     /* 重新匹配编程算法 */
-    BurnerCtrl.FlashBlob = FlashBlob_Get(BurnerCtrl.Info.DEV_ID & 0xFFF, BurnerCtrl.Info.FlashSize);   // 获取Flash编程算法
+    BurnerCtrl.FlashBlob = FlashBlob_Get(BurnerCtrl.Info.DEV_ID & 0xFFF,
+                                         BurnerCtrl.Info.FlashSize,
+                                         Burner_Parallelism());   // 获取Flash编程算法
     /* 算法错误 */
     if (BurnerCtrl.FlashBlob == NULL ||
         BurnerConfigInfo.FileSize == 0 ||
@@ -196,67 +673,63 @@ start:
     /* 获取文件大小 */
     BurnerCtrl.Info.ProgramSize = BurnerConfigInfo.FileSize;
     /* 初始化Flash编程算法 */
-    if (target_flash_init(BurnerCtrl.FlashBlob->prog_flash, 0x08000000) != ERROR_SUCCESS) {
+    if (target_flash_init(BurnerCtrl.FlashBlob->prog_flash,
+                          0x08000000,
+                          BurnerCtrl.FlashBlob->RamSize * 1024) != ERROR_SUCCESS) {
         BurnerCtrl.Error = BURNER_ERROR_FLASH_INIT;   // Flash初始化失败
         goto exit;                                    // 初始化失败
     }
     /* 发生了解除读保护，不需要擦除芯片了 */
     if (rdp < 2) {
-        if (BurnerConfigInfo.ChipErase != 0) {
-            /* 若配置了擦除全片则擦除全片 */
+        /* 增量烧录: 只擦写内容与镜像不一致的扇区, 扫描失败时全部擦写 */
+        if ((BurnerConfigInfo.ChipErase != CONFIG_CHIP_ERASE_ON) &&
+            (BurnerConfigInfo.Incremental != 0) &&
+            (Burner_DeltaScan() != ERROR_SUCCESS) &&
+            (BurnerCtrl.DeltaMap != NULL)) {
+            vPortFree(BurnerCtrl.DeltaMap);
+            BurnerCtrl.DeltaMap = NULL;
+        }
+        if ((BurnerConfigInfo.ChipErase == CONFIG_CHIP_ERASE_ON) ||
+            ((BurnerConfigInfo.ChipErase == CONFIG_CHIP_ERASE_AUTO) &&
+             (BurnerCtrl.DeltaMap == NULL) &&
+             (target_flash_erase_chip_faster(BurnerConfigInfo.FlashAddress, BurnerCtrl.Info.ProgramSize) != 0))) {
+            /* 配置了擦除全片, 或自动选择时整片擦除更快 */
             LED_On(RUN);
-            if (target_flash_erase_chip() != ERROR_SUCCESS) {
-                BurnerCtrl.Error = BURNER_ERROR_FLASH_ERASE;   // Flash擦除失败
-                goto exit;                                     // 擦除失败
+            if ((status = target_flash_erase_chip()) != ERROR_SUCCESS) {
+                BurnerCtrl.Error = Burner_FlashError(status, BURNER_ERROR_FLASH_ERASE);   // Flash擦除失败
+                goto exit;                                                                // 擦除失败
             }
             LED_Off(RUN);
-        } else {
+        } else if ((status = Burner_EraseSectors(&prefetch)) != ERROR_SUCCESS) {
             /* 擦除待编程的扇区 */
-            for (uint32_t i = 0; i < BurnerCtrl.Info.ProgramSize; i += CONFIG_BUFFER_SIZE) {
-                /* 擦除扇区 */
-                if (target_flash_sector_integer(BurnerConfigInfo.FlashAddress + i) != 0) {
-                    if (target_flash_erase_sector(BurnerConfigInfo.FlashAddress + i) != ERROR_SUCCESS) {
-                        BurnerCtrl.Error = BURNER_ERROR_FLASH_ERASE;   // Flash擦除失败
-                        goto exit;                                     // 擦除失败
-                    }
-                    LED_OnOff(RUN);
-                }
-            }
+            BurnerCtrl.Error = Burner_FlashError(status, BURNER_ERROR_FLASH_ERASE);   // Flash擦除失败
+            goto exit;                                                                // 擦除失败
         }
     }
-    /* 对Flash进行编程 */
-    while (BurnerCtrl.Info.ProgramSize - BurnerCtrl.Info.FinishSize) {
-        uint32_t rw_cnt = 0;   // 读写计数
-        if ((BurnerCtrl.Info.ProgramSize - BurnerCtrl.Info.FinishSize) > CONFIG_BUFFER_SIZE) {
-            /* 检查剩余字节数,若剩余字节大于缓存,读取缓存大小文件 */
-            rw_cnt = CONFIG_BUFFER_SIZE;
-        } else {
-            /* 剩余字节数大于0小于缓存,读取剩余字节数 */
-            rw_cnt = (BurnerCtrl.Info.ProgramSize - BurnerCtrl.Info.FinishSize);
-        }
-        SPI_FLASH_Read(BurnerCtrl.Buffer,
-                       BurnerConfigInfo.FileAddress + BurnerCtrl.Info.FinishSize,
-                       rw_cnt);
-        /* 对Flash进行编程 */
-        if (target_flash_program_page(
-                BurnerConfigInfo.FlashAddress + BurnerCtrl.Info.FinishSize,
-                BurnerCtrl.Buffer,
-                rw_cnt) != ERROR_SUCCESS) {
-            BurnerCtrl.Error = BURNER_ERROR_FLASH_PROGRAM;   // Flash编程失败
-            break;
-        }
-        BurnerCtrl.Info.FinishSize += rw_cnt;
-        BurnerCtrl.Info.FinishRate =
-            BurnerCtrl.Info.FinishSize * 1000 / BurnerCtrl.Info.ProgramSize;
-        LED_OnOff(RUN);
+    Burner_GangCheck(BURNER_ERROR_FLASH_ERASE);
+    /* 对Flash进行编程, 内容已一致的分块不需要编程 */
+    if ((status = Burner_Program(prefetch)) != ERROR_SUCCESS) {
+        BurnerCtrl.Error = Burner_FlashError(status, BURNER_ERROR_FLASH_PROGRAM);   // Flash编程失败
+    }
+    /* 等待最后一页编程完成 */
+    if ((BurnerCtrl.Error == BURNER_ERROR_NONE) &&
+        ((status = target_flash_sync()) != ERROR_SUCCESS)) {
+        BurnerCtrl.Error = Burner_FlashError(status, BURNER_ERROR_FLASH_PROGRAM);   // Flash编程失败
     }
     target_flash_uninit();
+    Burner_GangCheck(BURNER_ERROR_FLASH_PROGRAM);
 
     /* 校验代码 */
     if (BurnerConfigInfo.Verify != 0) {
         BurnerCtrl.Info.FinishSize = 0;   // 重置已完成大小
+        /* 下载CRC表后由目标一次校验多个分块 */
+        if ((target_flash_crc_capacity() >= 4) &&
+            ((status = Burner_VerifyTable()) != ERROR_SUCCESS)) {
+            BurnerCtrl.Error = Burner_FlashError(status, BURNER_ERROR_FLASH_VERIFY);   // Flash校验失败
+        }
         /* 对Flash内容进行校验 */
-        while (BurnerCtrl.Info.ProgramSize - BurnerCtrl.Info.FinishSize) {
+        while ((BurnerCtrl.Error == BURNER_ERROR_NONE) &&
+               (BurnerCtrl.Info.ProgramSize - BurnerCtrl.Info.FinishSize)) {
             uint32_t rw_cnt = 0;   // 读写计数
             uint32_t f_addr = SPI_FLASH_VERIFY_ADDRESS;
             uint32_t t_addr = BurnerConfigInfo.FlashAddress;
@@ -274,8 +747,8 @@ start:
             SPI_FLASH_Read(&crc, f_addr, 4);
 
             /* 对Flash进行编程 */
-            if (target_flash_verify(t_addr, rw_cnt, crc) != ERROR_SUCCESS) {
-                BurnerCtrl.Error = BURNER_ERROR_FLASH_VERIFY;   // Flash校验失败
+            if ((status = target_flash_verify(t_addr, rw_cnt, crc)) != ERROR_SUCCESS) {
+                BurnerCtrl.Error = Burner_FlashError(status, BURNER_ERROR_FLASH_VERIFY);   // Flash校验失败
                 break;
             }
             BurnerCtrl.Info.FinishSize += rw_cnt;
@@ -285,11 +758,12 @@ start:
             }
         }
     }
+    Burner_GangCheck(BURNER_ERROR_FLASH_VERIFY);
 
     /* 开启读保护 */
     if (BurnerConfigInfo.ReadProtection != 0) {
         /* 初始化选项字节编程算法 */
-        if (target_flash_init(BurnerCtrl.FlashBlob->prog_opt, 0) != ERROR_SUCCESS) {
+        if (target_flash_init(BurnerCtrl.FlashBlob->prog_opt, 0, BurnerCtrl.FlashBlob->RamSize * 1024) != ERROR_SUCCESS) {
             BurnerCtrl.Error = BURNER_ERROR_OPT_INIT;   // 选项字初始化失败
             goto exit;                                  // 初始化失败
         }
@@ -302,6 +776,7 @@ start:
         LED_Off(RUN);
         /* 反初始化选项字节编程算法 */
         target_flash_uninit();
+        Burner_GangCheck(BURNER_ERROR_OTP_SETRDP);
     }
 
     /* 编程完成，若配置了重启运行，则复位目标 */
@@ -312,6 +787,11 @@ start:
     }
 
 exit:
+    if (BurnerCtrl.DeltaMap != NULL) {
+        vPortFree(BurnerCtrl.DeltaMap);
+        BurnerCtrl.DeltaMap = NULL;
+    }
+    Burner_GangResult();
     if ((BurnerCtrl.Error != BURNER_ERROR_BUFFER) &&
         (BurnerCtrl.Error != BURNER_ERROR_NONE) &&
         (BurnerCtrl.ErrCnt <= BURNER_RETRY_COUNT)) {
@@ -327,6 +807,7 @@ exit:
         Beep(2000);
         LED_On(ERR);
     }
+    swd_set_clock(SWD_CLOCK_DEFAULT);   // 恢复默认时钟用于检测
     BurnerCtrl.EndTimer        = BURNER_AUTO_END_TIME;
     BurnerCtrl.State           = BURNER_STATE_FINISH;
     BurnerCtrl.Info.FinishTime = SysTick_Get() - tick;   // 计算完成时间
@@ -334,7 +815,7 @@ exit:
 
 /**
  * @brief  编程烧录任务
- * @note   100ms执行一次
+ * @note   BURNER_DETECT_CYCLE(ms)执行一次
  * @retval None
  */
 void Burner_Task(void) {
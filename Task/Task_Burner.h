@@ -1,15 +1,19 @@
 #ifndef __TASK_BURNER_H__
 #define __TASK_BURNER_H__
 
+#include "DAP_config.h"
 #include "flash_blob.h"
 #include "stdlib.h"
 #include "stm32f10x.h"
 
-#define BURNER_AUTO_START_TIME (1000 / 100)   // 识别后启动烧录时间
-#define BURNER_AUTO_END_TIME   (500 / 100)    // 断开后结束烧录时间
+#define BURNER_DETECT_CYCLE    20                            // 目标检测周期(ms)
+#define BURNER_AUTO_START_TIME (100 / BURNER_DETECT_CYCLE)   // 识别后启动烧录时间(连续探测成功次数)
+#define BURNER_AUTO_END_TIME   (500 / BURNER_DETECT_CYCLE)   // 断开后结束烧录时间(连续探测失败次数)
 
 #define BURNER_RETRY_COUNT 2   // 烧录失败重试次数
 
+#define BURNER_RECONNECT_TIME 2000   // 选项字重载后默认的最长重新连接时间(ms)
+
 typedef enum {
     BURNER_ERROR_NONE = 0,        // 无错误
     BURNER_ERROR_INIT,            // 初始化失败
@@ -25,6 +29,7 @@ typedef enum {
     BURNER_ERROR_CHIP_UNKNOWN,    // 未知芯片
     BURNER_ERROR_READ_FAIL,       // 读取失败
     BURNER_ERROR_FLASH_SIZE,      // 读取Flash大小失败
+    BURNER_ERROR_FLASH_TIMEOUT,   // Flash操作超时
 } Burner_Error_t;
 
 typedef enum {
@@ -36,6 +41,12 @@ typedef enum {
     BURNER_STATE_LOCK,       // 锁定状态
 } Burner_State_t;
 
+typedef struct {
+    uint16_t DevId;   // 设备ID
+    uint8_t  Clock;   // SWD时钟档位
+    uint8_t  Check;   // 校验
+} Burner_Speed_t;
+
 typedef struct {
     uint8_t          Online;                          // 在线状态
     uint8_t          ErrCnt;                          // 错误计数
@@ -44,7 +55,9 @@ typedef struct {
     Burner_State_t   State;                           // 工作状态
     Burner_Error_t   Error;                           // 错误码
     Burner_Error_t   ErrorList[BURNER_RETRY_COUNT];   // 错误码
-    uint8_t*         Buffer;                          // 烧录数据缓冲区
+    Burner_Error_t   GangError[SWD_GANG_COUNT];       // 各目标错误码
+    uint8_t*         Buffer;                          // 烧录数据缓冲区(2 * CONFIG_BUFFER_SIZE, 编程时双缓冲)
+    uint8_t*         DeltaMap;                        // 增量烧录需更新的分块位图
     FlashBlobList_t* FlashBlob;                       // 当前Flash编程算法
 
     struct {
@@ -57,11 +70,12 @@ typedef struct {
                 uint16_t REV_ID : 16;   // 版本ID
             };
         };
-        uint16_t FlashSize;     // Flash大小(Kb)
-        uint32_t ProgramSize;   // 程序大小
-        uint32_t FinishSize;    // 已完成大小
-        uint16_t FinishRate;    // 完成率
-        uint32_t FinishTime;    // 完成时间
+        uint16_t FlashSize;       // Flash大小(Kb)
+        uint32_t ProgramSize;     // 程序大小
+        uint32_t FinishSize;      // 已完成大小
+        uint16_t FinishRate;      // 完成率
+        uint32_t FinishTime;      // 完成时间
+        uint32_t ReconnectTime;   // 选项字重载后重新连接耗时(ms)
     } Info;
 } BurnerCtrl_t;
 
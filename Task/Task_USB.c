@@ -1,6 +1,7 @@
 #include "Task_USB.h"
 #include "buzzer.h"
 #include "hw_config.h"
+#include "mass_mal.h"
 #include "usb_pwr.h"
 
 /**
@@ -11,9 +12,16 @@
 void USB_Task(void) {
     static uint16_t usb_timeout = 0;
     if (USB_StateGet()) {
+        /* 主机停止写入后回写缓存 */
+        MAL_Idle();
         if (usb_timeout < 20) {
             usb_timeout++;
         } else if (bDeviceState != CONFIGURED) {
+            /* 卸载前回写缓存并释放缓存内存 */
+            NVIC_DisableIRQ(USB_LP_CAN1_RX0_IRQn);
+            MAL_Flush(0);
+            MAL_Release(0);
+            NVIC_EnableIRQ(USB_LP_CAN1_RX0_IRQn);
             USB_Unload();
             Beep(300);
         }
@@ -47,8 +47,8 @@ int main(void) {
     }
 
     /* 外设初始化 */
-    LED_Init();      // 初始化LED
-    W25QXX_Init();   // 初始化SPI Flash
+    LED_Init();          // 初始化LED
+    W25QXX_Init(NULL);   // 初始化SPI Flash (无时基, 不暂停擦除)
 
     SPI_Flash_2_Flash(SPI_FLASH_FIRMWARE_ADDRESS, CHIP_FIRMWARE_ADDRESS, size);
     /* 复位 */
@@ -52,10 +52,10 @@ uint32_t SysTick_Get(void);       // 获取系统滴答计数值
 TaskUnti_t TaskList[] = {
     /* 任务钩子，执行周期 */
     {TaskNull, 10},
-    {LED_Task, 50},       // LED任务，每500ms执行一次
-    {Key_Task, 10},       // 按键任务，每10ms执行一次
-    {Burner_Task, 100},   // 烧录任务，每100ms执行一次
-    {USB_Task, 100},      // 烧录任务，每100ms执行一次
+    {LED_Task, 50},                       // LED任务，每500ms执行一次
+    {Key_Task, 10},                       // 按键任务，每10ms执行一次
+    {Burner_Task, BURNER_DETECT_CYCLE},   // 烧录任务，每20ms执行一次
+    {USB_Task, 100},                      // 烧录任务，每100ms执行一次
 
     // 在上面添加任务。。。。
 };
@@ -78,10 +78,10 @@ int main(void) {
     RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOB, ENABLE);
 
     /* 外设初始化 */
-    LED_Init();      // 初始化LED
-    Key_Init();      // 初始化按键
-    W25QXX_Init();   // 初始化SPI Flash
-    Buzzer_Init();   // 初始化蜂鸣器
+    LED_Init();                 // 初始化LED
+    Key_Init();                 // 初始化按键
+    W25QXX_Init(SysTick_Get);   // 初始化SPI Flash
+    Buzzer_Init();              // 初始化蜂鸣器
 
     /* 初始化JSON */
     cJSON_Hooks hooks = {
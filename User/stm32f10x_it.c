@@ -27,6 +27,8 @@
 #include "usb_istr.h"
 #include "usb_pwr.h"
 
+#include "spi.h"
+
 /** @addtogroup STM32F10x_StdPeriph_Template
  * @{
  */
@@ -160,6 +162,15 @@ void USB_LP_CAN1_RX0_IRQHandler(void) {
 void USBWakeUp_IRQHandler(void) {
   EXTI_ClearITPendingBit(EXTI_Line18);
 }
+
+/**
+ * @brief  DMA1通道2中断(SPI1接收)
+ * @param  None
+ * @retval None
+ */
+void DMA1_Channel2_IRQHandler(void) {
+    SPI1_DmaIRQHandler();
+}
 /******************************************************************************/
 /*                 STM32F10x Peripherals Interrupt Handlers                   */
 /*  Add here the Interrupt Handler for the used peripheral(s) (PPP), for the  */